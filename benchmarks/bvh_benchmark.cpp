@@ -0,0 +1,258 @@
+// Microbenchmark for Bvh: build, refit and query times for random scenes of growing size.
+// Every query is checked against a brute force loop over all objects.
+// Usage: bvh_benchmark [max objects] [queries]
+#include "VulkanEngine/Bvh.h"
+#include "VulkanEngine/Frustum.h"
+#include "VulkanEngine/JobSystem.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace VulkanEngine;
+
+namespace {
+
+double elapsedMs(const std::function<void()>& body) {
+    auto start = std::chrono::high_resolution_clock::now();
+    body();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Best of iterations, in milliseconds
+double measure(uint32_t iterations, const std::function<void()>& body) {
+    double best = 1e30;
+    for (uint32_t i = 0; i < iterations; i++) {
+        best = std::min(best, elapsedMs(body));
+    }
+    return best;
+}
+
+void report(const char* name, double ms, const std::string& detail = {}) {
+    std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << ms << " ms  " << detail << std::endl;
+}
+
+// Same test as Bvh::queryFrustum applies to each object
+bool boxInFrustum(const Frustum& frustum, const Aabb& box) {
+    for (const glm::vec4& plane : frustum.planes) {
+        glm::vec3 normal(plane);
+        glm::vec3 positive(normal.x >= 0.0f ? box.max.x : box.min.x, normal.y >= 0.0f ? box.max.y : box.min.y,
+                           normal.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(normal, positive) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float rayDistance(const Aabb& box, const glm::vec3& origin, const glm::vec3& direction) {
+    float enter = 0.0f;
+    float exit = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+        float inverse = 1.0f / (std::abs(direction[axis]) > 1e-30f ? direction[axis] : 1e-30f);
+        float t0 = (box.min[axis] - origin[axis]) * inverse;
+        float t1 = (box.max[axis] - origin[axis]) * inverse;
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+bool runScene(JobSystem& jobSystem, uint32_t objectCount, uint32_t queryCount) {
+    // Constant density, so a query touches about as many objects at every size
+    float extent = 4.0f * std::cbrt(static_cast<float>(objectCount));
+    std::mt19937 rng(objectCount);
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> halfSize(0.25f, 1.5f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto randomBox = [&](const glm::vec3& center) {
+        glm::vec3 half(halfSize(rng), halfSize(rng), halfSize(rng));
+        Aabb box;
+        box.min = center - half;
+        box.max = center + half;
+        return box;
+    };
+    std::vector<Aabb> bounds(objectCount);
+    for (Aabb& box : bounds) {
+        box = randomBox(glm::vec3(position(rng), position(rng), position(rng)));
+    }
+
+    std::cout << objectCount << " objects" << std::endl;
+    Bvh bvh;
+    double buildMs = measure(objectCount >= 1000000 ? 1 : 3, [&] { bvh.build(bounds); });
+    report("build", buildMs, std::to_string(bvh.getNodeCount()) + " nodes");
+
+    bool ok = true;
+    std::vector<uint32_t> result;
+    std::vector<uint32_t> expected;
+
+    // Frusta from the center of the scene in random directions
+    std::vector<Frustum> frusta(queryCount);
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, extent);
+    for (Frustum& frustum : frusta) {
+        glm::vec3 direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+        frustum = Frustum::fromViewProjection(proj * glm::lookAt(glm::vec3(0.0f), direction, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+    size_t visible = 0;
+    double frustumMs = elapsedMs([&] {
+        for (const Frustum& frustum : frusta) {
+            result.clear();
+            bvh.queryFrustum(frustum, result);
+            visible += result.size();
+        }
+    });
+    report("frustum query", frustumMs / queryCount, std::to_string(visible / queryCount) + " visible on average");
+    double bruteFrustumMs = elapsedMs([&] {
+        for (uint32_t q = 0; q < std::min(queryCount, 16u); q++) {
+            expected.clear();
+            for (uint32_t i = 0; i < objectCount; i++) {
+                if (boxInFrustum(frusta[q], bounds[i])) {
+                    expected.push_back(i);
+                }
+            }
+            result.clear();
+            bvh.queryFrustum(frusta[q], result);
+            std::sort(result.begin(), result.end());
+            if (result != expected) {
+                std::cerr << "Frustum query " << q << " returned " << result.size() << " objects, expected " << expected.size() << std::endl;
+                ok = false;
+            }
+        }
+    });
+    report("  brute force", bruteFrustumMs / std::min(queryCount, 16u));
+
+    // Rays from random points in random directions
+    std::vector<glm::vec3> origins(queryCount);
+    std::vector<glm::vec3> directions(queryCount);
+    for (uint32_t q = 0; q < queryCount; q++) {
+        origins[q] = glm::vec3(position(rng), position(rng), position(rng));
+        directions[q] = glm::vec3(unit(rng), unit(rng), unit(rng));
+    }
+    std::vector<Bvh::RayHit> hits(queryCount);
+    double rayMs = elapsedMs([&] {
+        for (uint32_t q = 0; q < queryCount; q++) {
+            hits[q] = bvh.raycast(origins[q], directions[q]);
+        }
+    });
+    report("ray query", rayMs / queryCount);
+    for (uint32_t q = 0; q < std::min(queryCount, 64u); q++) {
+        float closest = FLT_MAX;
+        for (uint32_t i = 0; i < objectCount; i++) {
+            closest = std::min(closest, rayDistance(bounds[i], origins[q], directions[q]));
+        }
+        if (hits[q].distance != closest) {
+            std::cerr << "Ray " << q << " hit at " << hits[q].distance << ", expected " << closest << std::endl;
+            ok = false;
+        }
+    }
+
+    // Boxes about the size of a few objects
+    std::vector<Aabb> boxes(queryCount);
+    for (Aabb& box : boxes) {
+        box = randomBox(glm::vec3(position(rng), position(rng), position(rng)));
+        box.min = box.min - glm::vec3(2.0f);
+        box.max = box.max + glm::vec3(2.0f);
+    }
+    size_t overlapping = 0;
+    double aabbMs = elapsedMs([&] {
+        for (const Aabb& box : boxes) {
+            result.clear();
+            bvh.queryAabb(box, result);
+            overlapping += result.size();
+        }
+    });
+    report("aabb query", aabbMs / queryCount, std::to_string(static_cast<double>(overlapping) / queryCount) + " overlapping on average");
+    for (uint32_t q = 0; q < std::min(queryCount, 64u); q++) {
+        expected.clear();
+        for (uint32_t i = 0; i < objectCount; i++) {
+            if (bounds[i].overlaps(boxes[q])) {
+                expected.push_back(i);
+            }
+        }
+        result.clear();
+        bvh.queryAabb(boxes[q], result);
+        std::sort(result.begin(), result.end());
+        if (result != expected) {
+            std::cerr << "AABB query " << q << " returned " << result.size() << " objects, expected " << expected.size() << std::endl;
+            ok = false;
+        }
+    }
+
+    // Refit after 1% and then all of the objects moved a little
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    auto moveObjects = [&](uint32_t stride) {
+        for (uint32_t i = 0; i < objectCount; i += stride) {
+            glm::vec3 offset(step(rng), step(rng), step(rng));
+            bounds[i].min = bounds[i].min + offset;
+            bounds[i].max = bounds[i].max + offset;
+            bvh.update(i, bounds[i]);
+        }
+    };
+    moveObjects(100);
+    report("refit 1%", elapsedMs([&] { bvh.refit(); }));
+    moveObjects(1);
+    report("refit all", elapsedMs([&] { bvh.refit(); }));
+    for (int i = 0; i < 20; i++) {
+        moveObjects(1);
+        bvh.refit();
+    }
+    std::cout << "  cost after 21 moves   " << std::setprecision(2) << bvh.getCostRatio() << "x the built tree" << std::endl;
+
+    // Rebuild on the job system while this thread keeps refitting the old tree
+    uint32_t framesWhileRebuilding = 0;
+    double rebuildMs = elapsedMs([&] {
+        bvh.rebuildAsync(jobSystem);
+        while (!bvh.finishRebuild()) {
+            moveObjects(100);
+            bvh.refit();
+            framesWhileRebuilding++;
+            std::this_thread::yield();
+        }
+    });
+    report("async rebuild", rebuildMs, std::to_string(framesWhileRebuilding) + " refits meanwhile, cost " +
+                                           std::to_string(bvh.getCostRatio()) + "x");
+
+    // The rebuilt tree has to answer from the current bounds
+    for (uint32_t q = 0; q < std::min(queryCount, 16u); q++) {
+        expected.clear();
+        for (uint32_t i = 0; i < objectCount; i++) {
+            if (bounds[i].overlaps(boxes[q])) {
+                expected.push_back(i);
+            }
+        }
+        result.clear();
+        bvh.queryAabb(boxes[q], result);
+        std::sort(result.begin(), result.end());
+        if (result != expected) {
+            std::cerr << "AABB query " << q << " after the rebuild returned " << result.size() << " objects, expected "
+                      << expected.size() << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t maxObjects = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+    uint32_t queryCount = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1000;
+    queryCount = std::max(queryCount, 1u);
+
+    JobSystem jobSystem;
+    bool ok = true;
+    for (uint32_t objectCount = 10000; objectCount <= maxObjects; objectCount *= 10) {
+        ok = runScene(jobSystem, objectCount, queryCount) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
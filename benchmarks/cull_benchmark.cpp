@@ -0,0 +1,100 @@
+// Microbenchmark for FrustumCuller: culls a large random sphere set with every kernel the
+// CPU supports, single threaded and on the job system, and reports objects per nanosecond.
+// Usage: cull_benchmark [objects] [iterations]
+#include "VulkanEngine/Frustum.h"
+#include "VulkanEngine/FrustumCuller.h"
+#include "VulkanEngine/JobSystem.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace VulkanEngine;
+
+namespace {
+
+// Best of iterations, in nanoseconds
+double measure(uint32_t iterations, const std::function<void()>& body) {
+    double best = 1e30;
+    for (uint32_t i = 0; i < iterations; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+        best = std::min(best, ns);
+    }
+    return best;
+}
+
+void report(const char* name, uint32_t objects, size_t visible, double ns) {
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(10) << ns / 1e6 << " ms"
+              << std::setprecision(2) << std::setw(10) << objects / ns << " objects/ns"
+              << std::setw(12) << visible << " visible" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t objectCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+    uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 50;
+
+    // Spheres spread around the camera, roughly a fifth ends up inside the frustum
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 2.0f);
+    BoundingSpheres spheres;
+    spheres.resize(objectCount);
+    for (uint32_t i = 0; i < objectCount; i++) {
+        spheres.set(i, glm::vec3(position(rng), position(rng), position(rng)), radius(rng));
+    }
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    Frustum frustum = Frustum::fromViewProjection(proj * view);
+
+    std::cout << "Culling " << objectCount << " spheres, best of " << iterations << " runs, best kernel "
+              << FrustumCuller::getIsaName(FrustumCuller::getBestIsa()) << std::endl;
+
+    std::vector<uint32_t> reference;
+    std::vector<uint32_t> visible;
+    visible.reserve(objectCount);
+    bool mismatch = false;
+    for (FrustumCuller::Isa isa : {FrustumCuller::Isa::eScalar, FrustumCuller::Isa::eSSE, FrustumCuller::Isa::eAVX2}) {
+        FrustumCuller culler(isa);
+        if (culler.getIsa() != isa) {
+            continue; // Not supported here
+        }
+        double ns = measure(iterations, [&] {
+            visible.clear();
+            culler.cull(frustum, spheres, 0, objectCount, visible);
+        });
+        report(FrustumCuller::getIsaName(isa), objectCount, visible.size(), ns);
+        if (reference.empty()) {
+            reference = visible;
+        } else if (visible != reference) {
+            mismatch = true;
+            std::cerr << FrustumCuller::getIsaName(isa) << " disagrees with the scalar kernel" << std::endl;
+        }
+    }
+
+    JobSystem jobSystem;
+    FrustumCuller culler;
+    double ns = measure(iterations, [&] {
+        culler.cullParallel(jobSystem, frustum, spheres, visible);
+    });
+    std::string name = std::string(FrustumCuller::getIsaName(culler.getIsa())) + " x" + std::to_string(jobSystem.getThreadCount());
+    report(name.c_str(), objectCount, visible.size(), ns);
+    if (visible != reference) {
+        mismatch = true;
+        std::cerr << "Parallel culling disagrees with the scalar kernel" << std::endl;
+    }
+
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
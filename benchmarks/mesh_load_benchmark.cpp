@@ -0,0 +1,199 @@
+// Microbenchmark for MeshLoader: writes a torus of growing resolution as OBJ and as glb,
+// loads both and reports the throughput. Both have to come out with the torus' exact
+// vertex and triangle counts, so deduplication is checked too.
+// Given files instead, loads each of them.
+// Usage: mesh_load_benchmark [max segments] | mesh_load_benchmark <file.obj|file.glb>...
+#include "VulkanEngine/JobSystem.h"
+#include "VulkanEngine/MeshLoader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+namespace {
+
+// segments x segments quads; the seams repeat their positions with other texture
+// coordinates, so there are (segments + 1)^2 distinct vertices
+struct Torus {
+    uint32_t segments;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<uint32_t> indices; // Counter-clockwise seen from outside
+
+    explicit Torus(uint32_t segmentCount) : segments(segmentCount) {
+        const float pi = 3.14159265358979f;
+        for (uint32_t j = 0; j <= segments; j++) {
+            for (uint32_t i = 0; i <= segments; i++) {
+                // Wrap exactly, so the seams match bit for bit
+                float u = 2.0f * pi * (i % segments) / segments;
+                float v = 2.0f * pi * (j % segments) / segments;
+                glm::vec3 normal(std::cos(u) * std::cos(v), std::sin(u) * std::cos(v), std::sin(v));
+                positions.push_back(glm::vec3(std::cos(u), std::sin(u), 0.0f) + normal * 0.25f);
+                normals.push_back(normal);
+                texCoords.push_back(glm::vec2(static_cast<float>(i) / segments, static_cast<float>(j) / segments));
+            }
+        }
+        for (uint32_t j = 0; j < segments; j++) {
+            for (uint32_t i = 0; i < segments; i++) {
+                uint32_t a = j * (segments + 1) + i;
+                uint32_t b = a + 1;
+                uint32_t c = a + segments + 2;
+                uint32_t d = a + segments + 1;
+                indices.insert(indices.end(), {a, b, c, c, d, a});
+            }
+        }
+    }
+
+    uint64_t getTriangleCount() const { return indices.size() / 3; }
+};
+
+// Quads with v/vt/vn corners. The file's texture coordinates are bottom left based, the
+// loader flips them back.
+void writeObj(const Torus& torus, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    std::vector<char> line(256);
+    file << "# Torus, " << torus.segments << " segments\n";
+    for (size_t v = 0; v < torus.positions.size(); v++) {
+        const glm::vec3& p = torus.positions[v];
+        const glm::vec3& n = torus.normals[v];
+        const glm::vec2& t = torus.texCoords[v];
+        int length = std::snprintf(line.data(), line.size(), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", p.x, p.y,
+                                   p.z, t.x, 1.0f - t.y, n.x, n.y, n.z);
+        file.write(line.data(), length);
+    }
+    for (size_t i = 0; i < torus.indices.size(); i += 6) {
+        // a b c d of the quad, 1-based
+        uint32_t corners[4] = {torus.indices[i] + 1, torus.indices[i + 1] + 1, torus.indices[i + 2] + 1, torus.indices[i + 4] + 1};
+        int length = std::snprintf(line.data(), line.size(), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", corners[0], corners[0],
+                                   corners[0], corners[1], corners[1], corners[1], corners[2], corners[2], corners[2],
+                                   corners[3], corners[3], corners[3]);
+        file.write(line.data(), length);
+    }
+}
+
+// Non-indexed triangle list, so the loader has to find every shared vertex itself. The
+// positions are read through an interleaved buffer view, the other attributes through
+// tightly packed ones.
+void writeGlb(const Torus& torus, const std::string& path) {
+    size_t corners = torus.indices.size();
+    std::vector<float> interleaved; // Position, normal
+    std::vector<float> texCoords;
+    for (uint32_t index : torus.indices) {
+        const glm::vec3& p = torus.positions[index];
+        const glm::vec3& n = torus.normals[index];
+        interleaved.insert(interleaved.end(), {p.x, p.y, p.z, n.x, n.y, n.z});
+        texCoords.insert(texCoords.end(), {torus.texCoords[index].x, torus.texCoords[index].y});
+    }
+    size_t interleavedBytes = interleaved.size() * sizeof(float);
+    size_t texCoordBytes = texCoords.size() * sizeof(float);
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+                       "\"nodes\":[{\"mesh\":0}],"
+                       "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2}}]}],"
+                       "\"buffers\":[{\"byteLength\":" + std::to_string(interleavedBytes + texCoordBytes) + "}],"
+                       "\"bufferViews\":["
+                       "{\"buffer\":0,\"byteLength\":" + std::to_string(interleavedBytes) + ",\"byteStride\":24},"
+                       "{\"buffer\":0,\"byteOffset\":" + std::to_string(interleavedBytes) + ",\"byteLength\":" +
+                       std::to_string(texCoordBytes) + "}],"
+                       "\"accessors\":["
+                       "{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(corners) + ",\"type\":\"VEC3\"},"
+                       "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" + std::to_string(corners) +
+                       ",\"type\":\"VEC3\"},"
+                       "{\"bufferView\":1,\"componentType\":5126,\"count\":" + std::to_string(corners) + ",\"type\":\"VEC2\"}]}";
+    json.resize((json.size() + 3) / 4 * 4, ' ');
+
+    auto writeU32 = [](std::ofstream& file, uint32_t value) { file.write(reinterpret_cast<const char*>(&value), 4); };
+    size_t binBytes = interleavedBytes + texCoordBytes;
+    std::ofstream file(path, std::ios::binary);
+    writeU32(file, 0x46546C67);
+    writeU32(file, 2);
+    writeU32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binBytes));
+    writeU32(file, static_cast<uint32_t>(json.size()));
+    writeU32(file, 0x4E4F534A);
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    writeU32(file, static_cast<uint32_t>(binBytes));
+    writeU32(file, 0x004E4942);
+    file.write(reinterpret_cast<const char*>(interleaved.data()), static_cast<std::streamsize>(interleavedBytes));
+    file.write(reinterpret_cast<const char*>(texCoords.data()), static_cast<std::streamsize>(texCoordBytes));
+}
+
+void report(const std::string& name, const MeshLoadStats& stats) {
+    std::cout << "  " << std::left << std::setw(6) << name << std::right << std::fixed << std::setprecision(1) << std::setw(9)
+              << stats.bytes / (1024.0 * 1024.0) << " MB " << std::setw(9) << stats.totalMs << " ms (parse "
+              << stats.parseMs << ", dedup " << stats.dedupMs << ")  " << std::setw(7) << stats.getMegabytesPerSecond()
+              << " MB/s  " << std::setw(6) << stats.getTrianglesPerSecond() / 1e6 << " M triangles/s  " << stats.triangles
+              << " triangles, " << stats.vertices << " vertices" << std::endl;
+}
+
+bool check(const std::string& name, const Torus& torus, const MeshData& mesh) {
+    uint64_t expectedVertices = static_cast<uint64_t>(torus.segments + 1) * (torus.segments + 1);
+    if (mesh.indices.size() / 3 != torus.getTriangleCount() || mesh.vertices.size() != expectedVertices) {
+        std::cerr << name << ": " << mesh.indices.size() / 3 << " triangles and " << mesh.vertices.size() << " vertices, expected "
+                  << torus.getTriangleCount() << " and " << expectedVertices << std::endl;
+        return false;
+    }
+    // Every triangle faces away from the torus' ring, like its normals
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const MeshVertex& a = mesh.vertices[mesh.indices[i]];
+        const MeshVertex& b = mesh.vertices[mesh.indices[i + 1]];
+        const MeshVertex& c = mesh.vertices[mesh.indices[i + 2]];
+        glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+        if (glm::dot(normal, a.normal + b.normal + c.normal) <= 0.0f) {
+            std::cerr << name << ": triangle " << i / 3 << " is wound clockwise" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    JobSystem jobSystem;
+    MeshLoader loader(jobSystem);
+    std::cout << jobSystem.getThreadCount() << " threads" << std::endl;
+
+    bool ok = true;
+    if (argc > 1 && !std::isdigit(static_cast<unsigned char>(argv[1][0]))) {
+        for (int i = 1; i < argc; i++) {
+            try {
+                loader.loadFile(argv[i]);
+                report(std::filesystem::path(argv[i]).filename().string(), loader.getStats());
+            } catch (const std::exception& e) {
+                std::cerr << argv[i] << ": " << e.what() << std::endl;
+                ok = false;
+            }
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    uint32_t maxSegments = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1024;
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string objPath = (directory / "mesh_load_benchmark.obj").string();
+    std::string glbPath = (directory / "mesh_load_benchmark.glb").string();
+    for (uint32_t segments = 128; segments <= maxSegments; segments *= 2) {
+        Torus torus(segments);
+        std::cout << segments << " segments, " << torus.getTriangleCount() << " triangles" << std::endl;
+        writeObj(torus, objPath);
+        writeGlb(torus, glbPath);
+        ok = check("OBJ", torus, loader.loadFile(objPath)) && ok;
+        report("OBJ", loader.getStats());
+        ok = check("glb", torus, loader.loadFile(glbPath)) && ok;
+        report("glb", loader.getStats());
+    }
+    std::filesystem::remove(objPath);
+    std::filesystem::remove(glbPath);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
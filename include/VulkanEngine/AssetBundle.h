@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace VulkanEngine {
+
+// Bytes of one asset. Points into the mapping (or the binary) and stays valid as long as
+// the bundle does. data is nullptr if the asset doesn't exist.
+struct AssetView {
+    const void* data = nullptr;
+    size_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+// Read-only, memory-mapped asset bundle built by tools/pack_assets (format in
+// AssetBundleFormat.h). Opening maps the whole file and indexes the entry table; lookups
+// hand out pointers into the mapping, so loading an asset costs no open, read or copy.
+// Pages are faulted in by the OS on first touch.
+//
+// Builds with EMBED_ASSETS also carry the same assets in the binary, see findEmbedded.
+class AssetBundle {
+public:
+    // Throws if the file can't be mapped or isn't a valid bundle
+    explicit AssetBundle(const std::string& path);
+    ~AssetBundle();
+
+    // Prevent copying
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    AssetView find(const std::string& name) const;
+    size_t getAssetCount() const { return entries_.size(); }
+    size_t getMappedBytes() const { return size_; }
+
+    // Assets compiled into the executable, empty view if there are none or name is unknown
+    static AssetView findEmbedded(const std::string& name);
+
+private:
+    void validate();
+    void unmap();
+
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+    std::unordered_map<std::string, AssetView> entries_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of an asset bundle, shared by the engine and tools/pack_assets.
+// [BundleHeader][BundleEntry x entryCount][data...], little endian. Every entry's data
+// starts on a BUNDLE_ALIGNMENT boundary, so SPIR-V and vertex data can be used straight
+// out of the mapping.
+namespace VulkanEngine {
+
+constexpr uint32_t BUNDLE_MAGIC = 0x42414B56; // "VKAB"
+constexpr uint32_t BUNDLE_VERSION = 1;
+constexpr uint32_t BUNDLE_ALIGNMENT = 16;
+constexpr uint32_t BUNDLE_NAME_SIZE = 48;
+
+struct BundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct BundleEntry {
+    char name[BUNDLE_NAME_SIZE]; // Zero terminated
+    uint64_t offset; // From the start of the file
+    uint64_t size;
+};
+
+static_assert(sizeof(BundleHeader) == 16, "BundleHeader layout");
+static_assert(sizeof(BundleEntry) == 64, "BundleEntry layout");
+
+} // namespace VulkanEngine
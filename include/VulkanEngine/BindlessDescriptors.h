@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Indices a draw hands to the bindless shaders, through push constants.
+// Laid out to match the push_constant block in shaders/bindless.vert.
+struct DrawPushConstants {
+    uint32_t objectBuffer = 0;  // Storage buffer slot with the object data
+    uint32_t objectIndex = 0;   // First element of this draw in that buffer, + gl_InstanceIndex
+    uint32_t texture = 0;       // Sampled image slot
+    uint32_t pad = 0;
+};
+
+// One descriptor set with large update-after-bind arrays (descriptor indexing, core in 1.2):
+// binding 0 holds storage buffers, binding 1 combined image samplers. Resources are written
+// into a free slot once and shaders address them by that index, so the set is bound once per
+// frame no matter how many objects or textures there are, and adding a resource never
+// touches the set layout or the pool.
+//
+// Slots are partially bound, unused ones may stay empty. Writes are allowed while the set
+// is bound in pending command buffers, as long as those don't use the slot being written.
+// Thread-safe.
+class BindlessDescriptors {
+public:
+    static constexpr uint32_t STORAGE_BUFFER_BINDING = 0;
+    static constexpr uint32_t SAMPLED_IMAGE_BINDING = 1;
+
+    // Capacities are clamped to the device's update-after-bind limits
+    BindlessDescriptors(VulkanDevice& device, uint32_t maxStorageBuffers, uint32_t maxSampledImages);
+    ~BindlessDescriptors();
+
+    // Prevent copying
+    BindlessDescriptors(const BindlessDescriptors&) = delete;
+    BindlessDescriptors& operator=(const BindlessDescriptors&) = delete;
+
+    // Write the resource into a free slot and return its index. Throw when the array is full.
+    uint32_t addStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+    uint32_t addSampledImage(vk::ImageView view, vk::Sampler sampler,
+                             vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+    // Make a slot reusable. Only once no submitted frame reads it anymore.
+    void releaseStorageBuffer(uint32_t index);
+    void releaseSampledImage(uint32_t index);
+
+    vk::DescriptorSetLayout getLayout() const { return layout_; }
+    vk::DescriptorSet getSet() const { return set_; }
+    uint32_t getStorageBufferCapacity() const { return storageBuffers_.capacity; }
+    uint32_t getSampledImageCapacity() const { return sampledImages_.capacity; }
+
+private:
+    // Slots never used yet are handed out from next, released ones from freeList first
+    struct SlotArray {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> freeList;
+    };
+
+    uint32_t allocateSlot(SlotArray& slots, const char* what);
+
+    vk::Device device_;
+    vk::DescriptorSetLayout layout_ = nullptr;
+    vk::DescriptorPool pool_ = nullptr;
+    vk::DescriptorSet set_ = nullptr;
+
+    std::mutex mutex_; // Slot arrays and descriptor writes
+    SlotArray storageBuffers_;
+    SlotArray sampledImages_;
+};
+
+} // namespace VulkanEngine
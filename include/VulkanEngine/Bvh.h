@@ -0,0 +1,155 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "VulkanEngine/Frustum.h"
+#include "VulkanEngine/JobSystem.h"
+
+namespace VulkanEngine {
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void grow(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void grow(const Aabb& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    // 0 for an empty box
+    float surfaceArea() const {
+        glm::vec3 extent = glm::max(max - min, glm::vec3(0.0f));
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+    bool overlaps(const Aabb& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+};
+
+// Bounding volume hierarchy over object AABBs, for culling and picking queries that don't
+// touch every object.
+// Built top down with binned SAH. Nodes live in one array in depth-first order: a node's
+// left child directly follows it, so traversal mostly walks forward through memory, and
+// each node is 32 bytes, two per cache line. Leaves index a permuted object list, which
+// keeps every subtree's objects contiguous.
+//
+// update() only stores an object's new bounds; refit() then recomputes the boxes above the
+// changed leaves without changing the topology. Refitting is cheap, but the tree gets worse
+// as objects move away from where it was built; needsRebuild() compares the current SAH
+// cost with the cost after the last build, and rebuildAsync() builds a fresh tree from a
+// snapshot of the bounds on the job system while this one keeps serving queries.
+//
+// Queries are const and may run concurrently with each other, but not with update(),
+// refit() or finishRebuild().
+class Bvh {
+public:
+    static constexpr uint32_t INVALID_OBJECT = UINT32_MAX;
+
+    struct Node {
+        glm::vec3 min;
+        uint32_t offset; // Leaf: first entry in the object list. Interior: right child.
+        glm::vec3 max;
+        uint32_t count; // Objects in a leaf, 0 for interior nodes
+    };
+    static_assert(sizeof(Node) == 32, "Bvh::Node layout");
+
+    struct RayHit {
+        uint32_t object = INVALID_OBJECT;
+        float distance = FLT_MAX; // Along the ray to where it enters the object's box, 0 if it starts inside
+    };
+
+    Bvh() = default;
+    ~Bvh();
+
+    // Prevent copying
+    Bvh(const Bvh&) = delete;
+    Bvh& operator=(const Bvh&) = delete;
+
+    // Replaces the tree. Object i has bounds[i]; the count is fixed until the next build.
+    // Waits for a pending rebuildAsync().
+    void build(std::vector<Aabb> bounds);
+
+    // New bounds for one object, applied by the next refit()
+    void update(uint32_t object, const Aabb& bounds);
+    // Recomputes the boxes of the nodes above updated objects
+    void refit();
+
+    // Current SAH cost over the cost right after building, 1 for a fresh tree
+    float getCostRatio() const;
+    bool needsRebuild() const { return getCostRatio() > REBUILD_COST_RATIO; }
+
+    // Starts building a new tree from the current bounds on the job system. The old tree
+    // stays in use; finishRebuild() swaps the new one in once it's done. Both must be called
+    // from the same thread, and jobSystem must outlive the rebuild.
+    void rebuildAsync(JobSystem& jobSystem);
+    bool isRebuilding() const { return pending_ != nullptr; }
+    // Swaps a finished rebuild in and refits it with the updates made since its snapshot.
+    // Returns false if there was none or it is still running.
+    bool finishRebuild();
+
+    // Indices of the objects whose boxes intersect the frustum, appended to visible.
+    // Subtrees entirely inside it are taken whole without testing their objects.
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+    // Indices of the objects whose boxes overlap bounds, appended to result
+    void queryAabb(const Aabb& bounds, std::vector<uint32_t>& result) const;
+    // Closest object box hit by origin + t * direction, 0 <= t <= maxDistance. direction
+    // needn't be normalized; the distance is in units of its length.
+    RayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = FLT_MAX) const;
+
+    uint32_t getObjectCount() const { return static_cast<uint32_t>(bounds_.size()); }
+    uint32_t getNodeCount() const { return static_cast<uint32_t>(tree_.nodes.size()); }
+    const Aabb& getBounds(uint32_t object) const { return bounds_[object]; }
+
+    static constexpr uint32_t BIN_COUNT = 16; // SAH candidates per axis
+    static constexpr uint32_t MAX_LEAF_SIZE = 8; // Larger leaves are always split
+    // Relative to testing one object. Visiting a node costs more than testing the next box in a
+    // leaf's contiguous range, and the larger leaves this gives halve the node count.
+    static constexpr float TRAVERSAL_COST = 4.0f;
+    static constexpr float REBUILD_COST_RATIO = 1.5f;
+    static constexpr uint32_t MAX_DEPTH = 64; // Traversal stack size; the build never goes deeper
+
+private:
+    struct Tree {
+        std::vector<Node> nodes;
+        std::vector<uint32_t> parents; // [node], UINT32_MAX for the root
+        // Leaf ranges index these two: object indices and their boxes, in tree order
+        std::vector<uint32_t> objects;
+        std::vector<Aabb> objectBounds;
+        std::vector<uint32_t> objectSlots; // [object] position in objects
+        std::vector<uint32_t> objectLeaves; // [object] leaf holding it
+        double buildCost = 1.0; // SAH cost after the build, relative to the root's area
+    };
+
+    struct PendingRebuild {
+        std::vector<Aabb> bounds; // Snapshot the new tree is built from
+        Tree tree;
+        JobSystem* jobSystem = nullptr;
+        JobSystem::Counter done;
+    };
+
+    struct Builder;
+    static void buildTree(const std::vector<Aabb>& bounds, Tree& tree);
+    static double computeCost(const Tree& tree);
+    void waitForRebuild();
+    void resetRefitState();
+
+    std::vector<Aabb> bounds_; // [object], the latest from build() and update(); rebuilds start from these
+    Tree tree_;
+    std::vector<uint8_t> dirtyNodes_; // [node], set for leaves with updated objects and their ancestors
+    bool dirty_ = false;
+    double cost_ = 0.0; // SAH cost not divided by the root's area, kept current by refit()
+    std::unique_ptr<PendingRebuild> pending_;
+};
+
+} // namespace VulkanEngine
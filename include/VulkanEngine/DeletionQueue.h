@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace VulkanEngine {
+
+// Deferred destruction of GPU objects. Each deleter is tagged with a monotonically
+// increasing value (a frame number or timeline value) and runs once the GPU is known
+// to have passed it, so resources can be released mid-run without waiting for the device.
+//
+// Values passed to enqueue() must not decrease. Not thread-safe.
+class DeletionQueue {
+public:
+    DeletionQueue() = default;
+    ~DeletionQueue();
+
+    // Prevent copying
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    // deleter runs once collect() is called with a completed value >= retireValue
+    void enqueue(uint64_t retireValue, std::function<void()> deleter);
+
+    // Runs the deleters of everything the GPU has finished with, oldest first
+    void collect(uint64_t completedValue);
+    // Runs every pending deleter. Only call once the device is idle.
+    void flush();
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+private:
+    struct Entry {
+        uint64_t retireValue;
+        std::function<void()> deleter;
+    };
+
+    std::deque<Entry> entries_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Transient descriptor sets, valid for one frame. Every frame in flight has its own list of
+// pools; beginFrame resets them all with vkResetDescriptorPool (no per-set frees), and
+// allocate moves on to the next pool when one reports eErrorOutOfPoolMemory or
+// eErrorFragmentedPool. Only when a frame needs more than all of its pools together is a
+// new, larger pool created, and it stays for later frames. After the first few frames at
+// peak load allocation never creates pools and never fails.
+//
+// Pool sizes are given as descriptors per set, per type; a pool of N sets gets N times that.
+// Thread-safe.
+class DescriptorAllocator {
+public:
+    struct PoolRatio {
+        vk::DescriptorType type;
+        float descriptorsPerSet;
+    };
+
+    DescriptorAllocator(VulkanDevice& device, uint32_t frameCount, std::vector<PoolRatio> ratios, uint32_t initialSetsPerPool = 64);
+    ~DescriptorAllocator();
+
+    // Prevent copying
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    // Frees every set allocated in frameIndex's previous use. Call once the GPU is done with it.
+    void beginFrame(uint32_t frameIndex);
+
+    vk::DescriptorSet allocate(vk::DescriptorSetLayout layout);
+
+    size_t getPoolCount() const;
+
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+private:
+    struct Frame {
+        std::vector<vk::DescriptorPool> pools;
+        size_t current = 0; // Pools before this one are full for this frame
+    };
+
+    vk::DescriptorPool createPool(uint32_t setCount);
+
+    vk::Device device_;
+    std::vector<PoolRatio> ratios_;
+    uint32_t nextSetsPerPool_; // Grows by half with every pool created
+    mutable std::mutex mutex_;
+    std::vector<Frame> frames_;
+    uint32_t frameIndex_ = 0;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// One descriptor of a template update. An update passes an array of these, one per
+// descriptor in binding order (all array elements of a binding next to each other).
+union DescriptorData {
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+    VkBufferView texelBuffer;
+
+    static DescriptorData fromBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range);
+    static DescriptorData fromImage(vk::ImageView view, vk::Sampler sampler,
+                                    vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+};
+
+// Descriptor set layouts deduplicated by their bindings. Materials ask for the layout they
+// need and get the existing one if an identical set of bindings was seen before, so
+// layouts are created once and compatible pipelines share them.
+//
+// Also creates, per layout, an update template that writes every descriptor of a set
+// in one vkUpdateDescriptorSetWithTemplate call (core in 1.1) from a DescriptorData array.
+// Layouts and templates live as long as the cache. Thread-safe.
+class DescriptorLayoutCache {
+public:
+    explicit DescriptorLayoutCache(VulkanDevice& device);
+    ~DescriptorLayoutCache();
+
+    // Prevent copying
+    DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+    DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+    // Binding order doesn't matter. Immutable samplers are compared by handle.
+    vk::DescriptorSetLayout get(std::vector<vk::DescriptorSetLayoutBinding> bindings);
+
+    // Template for a layout returned by get(), created on first use
+    vk::DescriptorUpdateTemplate getUpdateTemplate(vk::DescriptorSetLayout layout);
+    // Number of DescriptorData entries an update of this layout reads
+    uint32_t getDescriptorCount(vk::DescriptorSetLayout layout);
+    // Writes every descriptor of set (allocated with layout) from data
+    void update(vk::DescriptorSet set, vk::DescriptorSetLayout layout, const DescriptorData* data);
+
+    size_t getLayoutCount() const;
+
+private:
+    struct LayoutInfo {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings; // Sorted by binding
+        std::vector<std::vector<vk::Sampler>> immutableSamplers; // What bindings' pImmutableSamplers point to
+        vk::DescriptorSetLayout layout = nullptr;
+        vk::DescriptorUpdateTemplate updateTemplate = nullptr;
+    };
+
+    static size_t hashBindings(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+    static bool equalBindings(const std::vector<vk::DescriptorSetLayoutBinding>& a,
+                              const std::vector<vk::DescriptorSetLayoutBinding>& b);
+    LayoutInfo& findInfo(vk::DescriptorSetLayout layout); // Caller holds mutex_
+
+    vk::Device device_;
+    mutable std::mutex mutex_;
+    std::vector<LayoutInfo> layouts_;
+    // Binding hash -> indices into layouts_ (collisions are resolved by comparing bindings)
+    std::unordered_multimap<size_t, size_t> byHash_;
+};
+
+} // namespace VulkanEngine
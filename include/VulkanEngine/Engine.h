@@ -9,6 +9,7 @@
 #include <string>
 #include <array> // Added for attribute descriptions
 #include <memory> // For unique_ptr
+#include <functional>
 
 // Forward declarations for Vulkan handles to avoid including vulkan.h here
 // This improves compile times if vulkan.h is large or changes often.
@@ -59,6 +60,28 @@ struct VkDebugUtilsMessengerCallbackDataEXT;
 #include "VulkanEngine/Camera.h" // Include Camera
 #include "VulkanEngine/InputManager.h" // Include InputManager
 #include "VulkanEngine/VulkanDevice.h" // Include VulkanDevice
+#include "VulkanEngine/MemoryAllocator.h"
+#include "VulkanEngine/StagingRing.h"
+#include "VulkanEngine/TransferQueue.h"
+#include "VulkanEngine/UploadBatcher.h"
+#include "VulkanEngine/FrameAllocator.h"
+#include "VulkanEngine/DeletionQueue.h"
+#include "VulkanEngine/MemoryBudget.h"
+#include "VulkanEngine/RenderGraph.h"
+#include "VulkanEngine/JobSystem.h"
+#include "VulkanEngine/ParallelRecorder.h"
+#include "VulkanEngine/AssetBundle.h"
+#include "VulkanEngine/Bvh.h"
+#include "VulkanEngine/BindlessDescriptors.h"
+#include "VulkanEngine/DescriptorAllocator.h"
+#include "VulkanEngine/DescriptorLayoutCache.h"
+#include "VulkanEngine/Frustum.h"
+#include "VulkanEngine/FrustumCuller.h"
+#include "VulkanEngine/MeshLoader.h"
+#include "VulkanEngine/MeshLod.h"
+#include "VulkanEngine/PipelineCache.h"
+#include "VulkanEngine/PipelineManager.h"
+#include "VulkanEngine/ShaderHotReload.h"
 
 namespace VulkanEngine {
 
@@ -93,15 +116,45 @@ struct Vertex {
 };
 
 struct UniformBufferObject {
-    glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
 };
 
+// Per-instance data, read by the vertex shaders with gl_InstanceIndex (std430 layout)
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color; // Multiplies the vertex color
+};
+
+// GPU culling inputs, std430 layouts of shaders/cull.comp
+struct CullObject {
+    glm::vec4 sphere; // Object space bounding sphere: center, radius
+    uint32_t mesh; // MeshInfo of the mesh's first LOD, the others follow it
+    uint32_t lodCount;
+    uint32_t lod; // Selected last frame, cull.comp keeps it for the hysteresis
+    uint32_t pad;
+};
+
+// One per LOD of every mesh
+struct MeshInfo {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    float error; // MeshLod::error
+};
+
+struct CullPushConstants {
+    glm::vec4 planes[6]; // Frustum::planes
+    glm::vec4 eye; // Camera position, w: viewport height / (2 tan(fovy / 2)) for getPixelsPerUnit
+    uint32_t objectCount;
+    uint32_t pad[3];
+};
+
 class Engine {
 public:
     // Constructor takes window parameters
-    Engine(int width = 800, int height = 600, const std::string& title = "Vulkan Engine");
+    // framesInFlight trades latency (1) for CPU/GPU overlap (up to MAX_FRAMES_IN_FLIGHT)
+    Engine(int width = 800, int height = 600, const std::string& title = "Vulkan Engine", uint32_t framesInFlight = 2);
     ~Engine();
 
     // Delete copy constructor and assignment operator
@@ -110,6 +163,18 @@ public:
 
     void run();
 
+    // Development mode: watch the GLSL sources in sourceDir and swap recompiled shaders in
+    // while running. Call before run().
+    void enableShaderHotReload(const std::string& sourceDir, const std::string& glslc);
+    // Replaces the single cube with objectCount spinning rounded cubes, drawn instanced with
+    // distance based LODs. Call before run().
+    void enableStressScene(uint32_t objectCount);
+    // Draws the .obj or .glb model at path instead of the cube, or the rounded cube of the
+    // stress scene, scaled to the cube's size. Call before run().
+    void enableMeshFile(const std::string& path);
+    // Culls on the CPU and draws from the CPU even where the GPU-driven path is available. Call before run().
+    void enableCpuCulling();
+
     Camera& getCamera() { return camera; } // Add getter for Camera
     const Camera& getCamera() const { return camera; }
 
@@ -131,27 +196,43 @@ private:
     // void createSurface(); // Needs VkInstance from Engine
     // void pickPhysicalDevice();
     // void createLogicalDevice();
-    void createSwapChain();
+    void createSwapChain(vk::SwapchainKHR oldSwapChain = nullptr);
     void createImageViews();
     void createRenderPass();
     void createDescriptorSetLayout();
-    void createGraphicsPipeline();
+    void createPipelineManager(); // Pipeline layout, scene shaders and vertex layout
+    void createGraphicsPipeline(); // Scene and fallback keys for the current formats
+    // From the asset bundle, the embedded copy or spirvPath, in that order (always spirvPath with hot reload)
+    PipelineManager::ShaderId loadShader(const std::string& assetName, const std::string& spirvPath, vk::ShaderStageFlagBits stage);
+    void updatePipelines(); // Applies finished shader reloads and retires replaced pipelines, between frames
     void createFramebuffers();
     void createCommandPool();
-    void createDepthResources();
+    void createRenderGraph(); // Also owns the depth buffer, as a transient
     void createVertexBuffer();
     void createIndexBuffer();
     void createUniformBuffers();
-    void createDescriptorPool();
-    void createDescriptorSets();
+    void createDescriptorPool(); // Set 0's pool and the per-frame descriptor allocator
+    void createDescriptorSets(); // Set 0 and the persistent bindless registrations
     void createCommandBuffers();
     void createSyncObjects();
+    void createMeshes(); // Vertex and index data of every mesh, with their LOD chains
+    // Appends a mesh to vertices and indices, with LODs simplified from it if there is enough to simplify
+    void addMesh(const std::vector<Vertex>& meshVertices, const std::vector<uint32_t>& meshIndices, const std::string& name);
+    MeshData loadCubeMesh(MeshLoader& loader); // models/cube.obj, from the asset bundle, the embedded copy or the file
+    void createScene(); // sceneObjects and their bounds
+    void createCullPipeline();
+    void createCullBuffers(); // Static per-object bounds, the mesh table and the LOD stats readback
 
     // Drawing and Frame Logic
     void drawFrame();
     void recreateSwapChain();
-    void cleanupSwapChain();
+    void cleanupSwapChain(); // Retires the size-dependent objects, not the swapchain itself
     void recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordScenePass(vk::CommandBuffer commandBuffer); // Render graph pass, draws into frameImageIndex
+    void recordSceneDraws(vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end); // Secondary, runs on worker threads
+    void recordCullPass(vk::CommandBuffer commandBuffer); // Compute, fills the indirect draws of the scene pass
+    void updateInstances(float time); // This frame's InstanceData, computed on all cores
+    void printLodStats(); // Objects and triangles drawn per LOD, from lodDrawCounts
     void updateUniformBuffer(uint32_t currentImage);
 
     // Vulkan Helpers (Removed more redundant ones)
@@ -159,30 +240,39 @@ private:
     // REMOVED: chooseSwapSurfaceFormat (moved to VulkanDevice)
     // REMOVED: chooseSwapPresentMode (moved to VulkanDevice)
     vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities); // KEEP here
-    vk::ShaderModule createShaderModule(const std::vector<char>& code); // Keep
-    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties); // Keep
-    void createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::Buffer& buffer, vk::DeviceMemory& bufferMemory); // Keep
-    void copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer, vk::DeviceSize size); // Keep
-    // Command buffer helpers (keep)
-    vk::CommandBuffer beginSingleTimeCommands();
-    void endSingleTimeCommands(vk::CommandBuffer commandBuffer);
+    // findMemoryType moved to VulkanDevice (used by MemoryAllocator)
+    void createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::Buffer& buffer, Allocation& bufferAllocation);
+    void destroyBuffer(vk::Buffer& buffer, Allocation& bufferAllocation);
+    // Runs deleter once every frame submitted so far has completed
+    void retire(std::function<void()> deleter);
+    // Streams data of any size into dstBuffer through the staging ring, UPLOAD_CHUNK_SIZE at a time
+    void uploadBuffer(const void* data, vk::DeviceSize size, vk::Buffer dstBuffer);
 
     // Input Handling
     void processInput(float deltaTime);
+    void pickObject(); // Reports the object under the crosshair
     void updateCameraVectors();
     // Input callbacks
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos);
 
-    // Static Helpers
-    std::vector<char> readFile(const std::string& filename);
-
     // --- Member Variables --- //
     std::unique_ptr<Window> window_; 
     std::unique_ptr<InputManager> inputManager_;
     Camera camera; 
     std::unique_ptr<VulkanDevice> vulkanDevice_;
+    std::unique_ptr<JobSystem> jobSystem_; // Frame CPU work (recording, culling, decode) is spread over this
+    std::unique_ptr<MemoryAllocator> allocator_; // Created in initVulkan, released in cleanup
+    std::unique_ptr<MemoryBudget> memoryBudget_; // Updated once per frame
+    float lastBudgetReport = 0.0f; // Time of the last printBudget
+    static constexpr float BUDGET_REPORT_INTERVAL = 10.0f; // Seconds
+    std::unique_ptr<TransferQueue> transferQueue_; // Uploads run here without blocking the frame
+    std::unique_ptr<StagingRing> stagingRing_; // All uploads are staged through this
+    std::unique_ptr<UploadBatcher> uploadBatcher_; // uploadBuffer queues here, flushed once per load phase / frame
+    static constexpr vk::DeviceSize STAGING_RING_SIZE = 16 * 1024 * 1024;
+    // Large meshes go through the ring in pieces, the batcher submits whenever half of it is staged
+    static constexpr vk::DeviceSize UPLOAD_CHUNK_SIZE = STAGING_RING_SIZE / 4;
 
     // Swap Chain
     vk::SwapchainKHR swapChain = nullptr;
@@ -192,47 +282,157 @@ private:
     std::vector<vk::ImageView> swapChainImageViews;
     std::vector<vk::Framebuffer> swapChainFramebuffers;
 
-    // Depth Buffer Resources (Keep)
-    vk::Image depthImage = nullptr;
-    vk::DeviceMemory depthImageMemory = nullptr;
-    vk::ImageView depthImageView = nullptr;
+    // Frame graph, rebuilt with the swap chain
+    std::unique_ptr<RenderGraph> renderGraph_;
+    RenderGraph::ResourceHandle swapChainResource = RenderGraph::INVALID_RESOURCE;
+    RenderGraph::ResourceHandle depthResource = RenderGraph::INVALID_RESOURCE;
+    uint32_t frameImageIndex = 0; // Swap chain image the graph renders to this frame
     vk::Format depthFormat; // Keep, but populated via vulkanDevice_
 
     // Pipeline & Rendering (Keep)
-    vk::RenderPass renderPass = nullptr;
-    vk::DescriptorSetLayout descriptorSetLayout = nullptr;
+    // With dynamic rendering there is no render pass and no framebuffers; the pipeline is
+    // built against the attachment formats and the scene pass renders straight to the views
+    bool useDynamicRendering = false;
+    vk::RenderPass renderPass = nullptr; // Owned by pipelineManager_
+    std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache_; // Owns every set layout but the bindless one
+    vk::DescriptorSetLayout descriptorSetLayout = nullptr; // Set 0, from descriptorLayoutCache_
     vk::PipelineLayout pipelineLayout = nullptr;
-    vk::Pipeline graphicsPipeline = nullptr;
+    std::unique_ptr<AssetBundle> assetBundle_; // Mapped for the engine's lifetime, nullptr without a bundle
+    static constexpr const char* ASSET_BUNDLE_PATH = "assets.bundle";
+    std::unique_ptr<PipelineCache> pipelineCache_; // Loaded in initVulkan, saved in cleanup
+    std::unique_ptr<PipelineManager> pipelineManager_; // Owns all pipelines and render passes
+    PipelineManager::ShaderId sceneVertexShader = 0;
+    PipelineManager::ShaderId sceneFragmentShader = 0;
+    PipelineManager::VertexLayoutId sceneVertexLayout = 0;
+    PipelineKey scenePipelineKey;
+    PipelineKey fallbackPipelineKey;
+    vk::Pipeline scenePipeline = nullptr; // Resolved per frame from scenePipelineKey
+    std::string shaderSourceDir; // Hot reload is on when set
+    std::string glslcPath;
+    std::unique_ptr<ShaderHotReload> shaderHotReload_;
+    static constexpr const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
     vk::CommandPool commandPool = nullptr;
 
     // Buffers & Memory (Keep)
     vk::Buffer vertexBuffer = nullptr;
-    vk::DeviceMemory vertexBufferMemory = nullptr;
+    Allocation vertexBufferAllocation;
     vk::Buffer indexBuffer = nullptr;
-    vk::DeviceMemory indexBufferMemory = nullptr;
-    std::vector<vk::Buffer> uniformBuffers;
-    std::vector<vk::DeviceMemory> uniformBuffersMemory;
-    std::vector<void*> uniformBuffersMapped; // For UBO updates
+    Allocation indexBufferAllocation;
+    // Per-frame uniform data, bound through a dynamic offset into one buffer
+    std::unique_ptr<FrameAllocator> uniformAllocator_;
+    static constexpr vk::DeviceSize UNIFORM_BYTES_PER_FRAME = 1024 * 1024;
+    uint32_t uboDynamicOffset = 0; // Offset of this frame's UniformBufferObject
 
     // Descriptors (Keep)
-    vk::DescriptorPool descriptorPool = nullptr;
-    std::vector<vk::DescriptorSet> descriptorSets;
+    vk::DescriptorPool descriptorPool = nullptr; // Holds set 0 only
+    vk::DescriptorSet descriptorSet = nullptr; // Shared by all frames, only the dynamic offsets differ
+    std::unique_ptr<DescriptorAllocator> descriptorAllocator_; // Sets valid for one frame, reset wholesale
+
+    // Bindless mode: set 1 holds every object buffer and texture, draws pick theirs through
+    // DrawPushConstants. Off when the device lacks descriptor indexing.
+    bool useBindless = false;
+    std::unique_ptr<BindlessDescriptors> bindless_;
+    static constexpr uint32_t BINDLESS_MAX_STORAGE_BUFFERS = 65536;
+    static constexpr uint32_t BINDLESS_MAX_SAMPLED_IMAGES = 16384;
+    // Per-frame InstanceData. Bound in set 0 through a dynamic offset, and registered once as
+    // a bindless storage buffer.
+    std::unique_ptr<FrameAllocator> objectAllocator_;
+    static constexpr vk::DeviceSize OBJECT_BYTES_PER_FRAME = 4 * 1024 * 1024; // Minimum, grows with the scene
+    vk::DeviceSize instanceOffset = 0; // This frame's InstanceData array in objectAllocator_'s buffer
+    uint32_t objectBufferIndex = 0; // Bindless slot of objectAllocator_'s buffer
+    uint32_t objectBaseIndex = 0; // Element of this frame's first object in that buffer
 
     // Command Buffers (one per frame in flight)
     std::vector<vk::CommandBuffer> commandBuffers;
+    std::unique_ptr<ParallelRecorder> parallelRecorder_; // Scene draws are recorded into secondaries on all cores
+
+    // Meshes in vertices and indices, each with its chain of LODs in meshLods
+    struct Mesh {
+        int32_t vertexOffset;
+        uint32_t firstLod; // Into meshLods
+        uint32_t lodCount;
+        float radius; // Bounding sphere around the origin
+    };
+    std::vector<Mesh> meshes; // 0 is the cube, then the stress scene's rounded cube and the --mesh model if enabled
+    uint32_t sceneMesh = 0; // What the scene's objects are instances of, the last of meshes
+    std::string meshPath; // Model file from enableMeshFile, empty for none
+    std::vector<MeshLod> meshLods; // firstIndex is into indices
+    static constexpr uint32_t ROUNDED_CUBE_SUBDIVISIONS = 16; // Quads along each edge of a face
+
+    // Scene: every object is an instance of one of the meshes
+    struct SceneObject {
+        glm::vec3 position;
+        glm::vec3 axis; // Spins around this, normalized
+        float angularSpeed; // Radians per second
+        glm::vec4 color;
+        uint32_t mesh; // Index into meshes
+    };
+    std::vector<SceneObject> sceneObjects;
+    BoundingSpheres sceneBounds; // One per scene object, objects only spin so these never move
+    Bvh sceneBvh_; // Over the boxes around sceneBounds, for picking
+    bool pickHeld = false; // Left button state last frame, a pick happens on press
+    uint32_t stressObjectCount = 0; // 0 for the single cube
+
+    // CPU path: sceneBounds are culled with SIMD on all cores, every visible object picks
+    // its LOD, and only those objects get InstanceData, grouped into one draw per LOD
+    FrustumCuller frustumCuller_;
+    std::vector<uint32_t> visibleObjects; // Indices into sceneObjects, in draw order
+    std::vector<uint32_t> visibleLods; // [visible object] meshLods entry it is drawn with
+    std::vector<uint32_t> sortedObjects; // Scratch for grouping visibleObjects by LOD
+    std::vector<uint8_t> objectLods; // [object] LOD of its mesh selected last frame
+    std::vector<vk::DrawIndexedIndirectCommand> frameDraws; // Draw list of the scene pass
+    float lodProjScale = 0.0f; // This frame's viewport height / (2 tan(fovy / 2))
+
+    // Objects drawn per meshLods entry. Counted by the CPU path, or read back from cull.comp
+    // framesInFlight frames late.
+    std::vector<uint32_t> lodDrawCounts;
+    float lastLodReport = 0.0f; // Time of the last printLodStats, the stress scene prints every 2 s
+
+    // GPU-driven path: cull.comp tests every object against the frustum and appends an
+    // indirect draw per visible one; the scene pass issues them all with a single
+    // drawIndexedIndirectCount, so CPU cost doesn't grow with the object count.
+    // Off (CPU culling and draws) without multiDrawIndirect and drawIndirectCount.
+    bool useGpuCulling = false;
+    bool forceCpuCulling = false;
+    static constexpr uint32_t CULL_GROUP_SIZE = 64; // local_size_x in cull.comp
+    vk::DescriptorSetLayout cullSetLayout = nullptr; // From descriptorLayoutCache_
+    vk::PipelineLayout cullPipelineLayout = nullptr;
+    vk::Pipeline cullPipeline = nullptr; // Owned by pipelineManager_
+    vk::Buffer cullObjectBuffer = nullptr; // CullObject per scene object
+    Allocation cullObjectBufferAllocation;
+    vk::Buffer meshInfoBuffer = nullptr;
+    Allocation meshInfoBufferAllocation;
+    // cull.comp counts the objects per meshLods entry behind the draw count; every frame
+    // copies them to its own slot of this host-visible buffer
+    vk::Buffer lodStatsBuffer = nullptr;
+    Allocation lodStatsBufferAllocation;
+    RenderGraph::ResourceHandle cullObjectResource = RenderGraph::INVALID_RESOURCE; // Imported, CullObject::lod carries over
+    RenderGraph::ResourceHandle cullDrawResource = RenderGraph::INVALID_RESOURCE;
+    RenderGraph::ResourceHandle cullCountResource = RenderGraph::INVALID_RESOURCE;
+    RenderGraph::ResourceHandle lodStatsResource = RenderGraph::INVALID_RESOURCE;
+    Frustum cullFrustum; // This frame's, from updateInstances
 
     // Synchronization
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2; // Moved here
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    uint32_t framesInFlight; // 1..MAX_FRAMES_IN_FLIGHT, set at construction
     std::vector<vk::Semaphore> imageAvailableSemaphores;
     std::vector<vk::Semaphore> renderFinishedSemaphores;
-    std::vector<vk::Fence> inFlightFences;
-    uint32_t currentFrame = 0;
+    // Signaled with the frame number by every graphics submit. CPU pacing, deferred
+    // deletion and per-frame resource reuse all key off its value.
+    vk::Semaphore frameTimeline = nullptr;
+    uint32_t currentFrame = 0; // frameNumber % framesInFlight of the frame being recorded
+    uint64_t frameNumber = 0; // Frames submitted so far
+    uint64_t completedFrameNumber = 0; // Last value seen on frameTimeline
+    DeletionQueue deletionQueue_;
+    // Transfer timeline value (and stages) the frame being recorded has to wait for, 0 if none
+    uint64_t transferWaitValue = 0;
+    vk::PipelineStageFlags transferWaitStages;
 
     bool framebufferResized = false; // Keep this!
 
-    // Vertex Data (Keep for now)
-    const std::vector<Vertex> vertices;
-    const std::vector<uint16_t> indices;
+    // Vertex and index data of every mesh, see meshes
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
 
     // Timing (Keep for now)
     float deltaTime = 0.0f;
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstring>
+
+#include "VulkanEngine/MemoryAllocator.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Per-frame bump allocator over one large, persistently mapped host-visible buffer.
+// The buffer is split into one region per frame in flight. Slices are aligned to
+// minUniformBufferOffsetAlignment (and minStorageBufferOffsetAlignment for storage
+// buffers) and meant to be bound through dynamic descriptors, so one descriptor set
+// serves every frame and only the dynamic offset changes. A frame's region is reset
+// wholesale in beginFrame, once the frame timeline shows the GPU is done with it.
+class FrameAllocator {
+public:
+    struct Slice {
+        void* data = nullptr;  // Mapped pointer to the slice
+        uint32_t offset = 0;   // Offset into getBuffer(), i.e. the dynamic offset to bind
+        vk::DeviceSize size = 0;
+    };
+
+    FrameAllocator(VulkanDevice& device, MemoryAllocator& allocator, vk::DeviceSize bytesPerFrame, uint32_t frameCount,
+                   vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eUniformBuffer);
+    ~FrameAllocator();
+
+    // Prevent copying
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // Starts handing out slices from frameIndex's region. Call once the GPU is done with it.
+    void beginFrame(uint32_t frameIndex);
+
+    Slice allocate(vk::DeviceSize size);
+
+    template <typename T>
+    Slice push(const T& value) {
+        Slice slice = allocate(sizeof(T));
+        memcpy(slice.data, &value, sizeof(T));
+        return slice;
+    }
+
+    vk::Buffer getBuffer() const { return buffer_; }
+    vk::DeviceSize getAlignment() const { return alignment_; }
+    vk::DeviceSize getUsedBytes() const { return head_ - frameBase_; }
+
+private:
+    vk::Device device_;
+    MemoryAllocator& allocator_;
+
+    vk::Buffer buffer_ = nullptr;
+    Allocation allocation_;
+    vk::DeviceSize alignment_ = 0;
+    vk::DeviceSize bytesPerFrame_ = 0; // Rounded up to alignment_
+    uint32_t frameCount_ = 0;
+
+    vk::DeviceSize frameBase_ = 0; // Start of the current frame's region
+    vk::DeviceSize head_ = 0;      // Next free byte in the current region
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace VulkanEngine {
+
+// View frustum as six planes (xyz = inward normal, w = distance), so a point p is inside
+// a plane when dot(xyz, p) + w >= 0. Order: left, right, bottom, top, near, far.
+// Shared by the CPU culling code and, as push constants, by shaders/cull.comp.
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    // Gribb/Hartmann extraction from a projection * view matrix. The near plane is the
+    // OpenGL one (-w <= z), which is slightly conservative for Vulkan's 0..1 depth.
+    static Frustum fromViewProjection(const glm::mat4& viewProjection);
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "VulkanEngine/Frustum.h"
+
+namespace VulkanEngine {
+
+class JobSystem;
+
+// World space bounding spheres as structure of arrays, so the culling kernels load eight
+// centers or radii with one instruction. Arrays are padded to a multiple of 8 with spheres
+// that are never visible, so the kernels need no remainder loop.
+class BoundingSpheres {
+public:
+    void resize(uint32_t count);
+    void set(uint32_t index, const glm::vec3& center, float radius);
+
+    uint32_t size() const { return count_; }
+    const float* centerX() const { return centerX_.data(); }
+    const float* centerY() const { return centerY_.data(); }
+    const float* centerZ() const { return centerZ_.data(); }
+    const float* radius() const { return radius_.data(); }
+
+private:
+    uint32_t count_ = 0;
+    std::vector<float> centerX_;
+    std::vector<float> centerY_;
+    std::vector<float> centerZ_;
+    std::vector<float> radius_;
+};
+
+// CPU frustum culling of BoundingSpheres, eight spheres per iteration.
+// The kernel is picked at construction from what the CPU supports: AVX2 (8 wide), SSE
+// (two 4-wide halves) or scalar. All three produce the same, ascending, index lists.
+class FrustumCuller {
+public:
+    enum class Isa {
+        eScalar,
+        eSSE,
+        eAVX2
+    };
+
+    // Best kernel this CPU and build support
+    FrustumCuller();
+    // A specific kernel, clamped to what is supported (for benchmarks and comparisons)
+    explicit FrustumCuller(Isa isa);
+
+    // Indices of the spheres in [begin, end) that intersect the frustum, appended to visible
+    void cull(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t begin, uint32_t end,
+              std::vector<uint32_t>& visible) const;
+    // All spheres, in chunks spread over the job system. Replaces visible.
+    void cullParallel(JobSystem& jobSystem, const Frustum& frustum, const BoundingSpheres& spheres,
+                      std::vector<uint32_t>& visible) const;
+
+    Isa getIsa() const { return isa_; }
+    static Isa getBestIsa();
+    static const char* getIsaName(Isa isa);
+
+    static constexpr uint32_t CHUNK_SIZE = 16384; // Spheres per job, a multiple of 8
+
+private:
+    uint32_t cullRange(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t begin, uint32_t end,
+                       uint32_t* out) const;
+
+    Isa isa_;
+};
+
+} // namespace VulkanEngine
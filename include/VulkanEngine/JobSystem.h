@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VulkanEngine {
+
+// Work-stealing task scheduler.
+// Every thread (workers plus the thread that created the system, index 0) owns a deque.
+// New jobs go to the back of the submitting thread's deque; a thread runs its own newest
+// job first and otherwise steals the oldest job of another thread. Threads that wait on a
+// counter keep running jobs instead of blocking, so nested waits cannot deadlock.
+// Background jobs go to one shared queue that only idle workers drain, never wait(), so
+// long jobs like pipeline compiles can't end up on a thread waiting for frame work.
+//
+// getThreadIndex() is stable per thread and below getThreadCount(), which makes it usable
+// for per-thread resources such as command pools. Only the creating thread and the
+// workers should submit jobs that rely on it.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // Number of unfinished jobs attached to it. Must outlive those jobs; wait() on it
+    // before destroying it.
+    class Counter {
+    public:
+        Counter() = default;
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        bool isDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> pending_{0};
+        std::mutex mutex_;
+        std::vector<std::pair<Job, Counter*>> continuations_; // Run once pending_ drops to 0
+        std::exception_ptr error_;
+    };
+
+    // workerCount 0 uses one worker per hardware thread besides the calling one, and at
+    // least one worker
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    // Prevent copying
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(Job job, Counter* counter = nullptr);
+    // Runs job on a worker once the workers have nothing else to do, oldest first
+    void runBackground(Job job, Counter* counter = nullptr);
+    // job is queued once dependency is done
+    void runAfter(Counter& dependency, Job job, Counter* counter = nullptr);
+    // Runs other jobs until counter is done, then rethrows the first exception of its jobs
+    void wait(Counter& counter);
+
+    // Calls body(begin, end) over [0, count) in batches of at least minBatchSize, spread over all threads
+    void parallelFor(uint32_t count, uint32_t minBatchSize, const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(queues_.size()); }
+    static uint32_t getThreadIndex() { return threadIndex_; }
+
+private:
+    struct Task {
+        Job job;
+        Counter* counter;
+    };
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    void pushBackground(Task task);
+    // Background jobs are only taken with includeBackground, i.e. by idle workers
+    bool tryRunOne(bool includeBackground);
+    void finish(Counter* counter, std::exception_ptr error);
+    void workerLoop(uint32_t threadIndex);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_; // [thread index]
+    WorkQueue backgroundQueue_;
+    std::vector<std::thread> workers_;
+    std::atomic<uint32_t> queuedTasks_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+
+    static thread_local uint32_t threadIndex_;
+};
+
+} // namespace VulkanEngine
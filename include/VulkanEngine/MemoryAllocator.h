@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include "VulkanEngine/TlsfAllocator.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+class MemoryBudget;
+struct MemoryBlock; // Defined in MemoryAllocator.cpp
+
+// What kind of resource is bound to the memory. Linear (buffers) and optimal (images)
+// resources never share a block, which keeps bufferImageGranularity from ever applying.
+enum class ResourceKind {
+    eBuffer,
+    eImage
+};
+
+// A sub-range of a VkDeviceMemory block (or a whole dedicated allocation)
+struct Allocation {
+    vk::DeviceMemory memory = nullptr;
+    vk::DeviceSize offset = 0;
+    vk::DeviceSize size = 0;
+    void* mappedData = nullptr; // Non-null for host-visible memory, which stays persistently mapped
+    uint32_t memoryTypeIndex = 0;
+
+    // Internal bookkeeping for MemoryAllocator::free
+    MemoryBlock* block = nullptr; // nullptr for dedicated allocations
+    uint32_t node = TlsfAllocator::INVALID_NODE;
+
+    explicit operator bool() const { return static_cast<bool>(memory); }
+};
+
+// Per-heap usage numbers, as reported by MemoryAllocator::getHeapStats
+struct HeapStats {
+    uint32_t blockCount = 0;            // VkDeviceMemory blocks used for sub-allocation
+    uint32_t dedicatedCount = 0;        // VkDeviceMemory objects owned by a single resource
+    uint32_t allocationCount = 0;       // Live allocations (sub-allocated + dedicated)
+    vk::DeviceSize blockBytes = 0;      // Bytes reserved from the driver (blocks + dedicated)
+    vk::DeviceSize allocationBytes = 0; // Bytes handed out to resources
+    vk::DeviceSize heapSize = 0;
+};
+
+// Sub-allocating device memory allocator.
+// Memory is reserved from the driver in large blocks per memory type and carved up with
+// a TLSF allocator, so resources no longer each cost a vkAllocateMemory (and a slot of
+// maxMemoryAllocationCount). Large resources, and images the driver would rather keep to
+// themselves, get a dedicated allocation instead.
+class MemoryAllocator {
+public:
+    explicit MemoryAllocator(VulkanDevice& device);
+    ~MemoryAllocator();
+
+    // Prevent copying
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    // Allocate memory for the resource and bind it
+    Allocation allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties);
+    Allocation allocateImage(vk::Image image, vk::MemoryPropertyFlags properties);
+
+    // Raw allocation when the caller binds the memory itself
+    Allocation allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties,
+                        ResourceKind kind, bool dedicated = false);
+    void free(Allocation& allocation);
+
+    std::vector<HeapStats> getHeapStats() const;
+    void printStats(std::ostream& out) const;
+
+    // With a budget set, memory types whose heap would go over it are skipped in favour
+    // of the next matching type. nullptr turns that off.
+    void setBudget(const MemoryBudget* budget);
+
+private:
+    // Both expect mutex_ to be held
+    Allocation allocateLocked(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties,
+                              ResourceKind kind, bool dedicated, vk::Buffer buffer, vk::Image image);
+    Allocation allocateDedicated(const vk::MemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                                 vk::Buffer buffer, vk::Image image);
+    MemoryBlock* createBlock(uint32_t memoryTypeIndex, uint32_t poolKey);
+    void destroyBlock(MemoryBlock* block);
+    uint32_t chooseMemoryType(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties) const;
+    vk::DeviceSize preferredBlockSize(uint32_t memoryTypeIndex) const;
+    uint32_t poolKey(uint32_t memoryTypeIndex, ResourceKind kind) const;
+    void* mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryTypeIndex, vk::DeviceSize size);
+    void checkAllocationCount() const;
+
+    VulkanDevice& vulkanDevice_;
+    vk::Device device_;
+    vk::PhysicalDeviceMemoryProperties memoryProperties_;
+    vk::DeviceSize bufferImageGranularity_ = 1;
+    uint32_t maxMemoryAllocationCount_ = 0;
+    bool dedicatedAllocationQueries_ = false; // vkGet*MemoryRequirements2 is available (Vulkan 1.1)
+
+    mutable std::mutex mutex_;
+    // Blocks grouped by memory type and resource kind
+    std::unordered_map<uint32_t, std::vector<std::unique_ptr<MemoryBlock>>> pools_;
+    uint32_t deviceMemoryCount_ = 0;
+    std::vector<HeapStats> heapStats_;
+    const MemoryBudget* budget_ = nullptr;
+
+    // Allocations bigger than this fraction of a block go dedicated
+    static constexpr vk::DeviceSize DEDICATED_THRESHOLD_DIVISOR = 2;
+};
+
+} // namespace VulkanEngine
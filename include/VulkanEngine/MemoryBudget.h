@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+class MemoryAllocator;
+
+// Usage and budget of one memory heap, refreshed by MemoryBudget::update
+struct HeapBudget {
+    vk::DeviceSize usage = 0;  // Whole process (driver numbers) or our own blocks (estimate)
+    vk::DeviceSize budget = 0; // What we can use before the driver starts paging
+    vk::DeviceSize heapSize = 0;
+    bool deviceLocal = false;
+};
+
+// Tracks per-heap memory usage against the budget. Uses VK_EXT_memory_budget when the
+// device has it; otherwise usage is what MemoryAllocator has reserved and the budget is a
+// fixed fraction of the heap. When a heap gets close to its budget the registered eviction
+// callbacks are asked to release streamable resources.
+//
+// MemoryAllocator consults fits() to skip memory types whose heap is over budget.
+class MemoryBudget {
+public:
+    // Called with the heap and how many bytes it should give up. Returns the bytes it
+    // actually released (or retired through the deletion queue).
+    using EvictionCallback = std::function<vk::DeviceSize(uint32_t heapIndex, vk::DeviceSize bytesToFree)>;
+
+    MemoryBudget(VulkanDevice& device, MemoryAllocator& allocator);
+
+    // Prevent copying
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // Refresh the numbers and evict if needed. Call once per frame.
+    void update();
+
+    std::vector<HeapBudget> getHeapBudgets() const;
+    bool hasDriverBudget() const { return driverBudget_; }
+
+    // Would allocating size more bytes in the heap stay within budget? ownBytes is what
+    // the allocator has reserved from that heap right now.
+    bool fits(uint32_t heapIndex, vk::DeviceSize size, vk::DeviceSize ownBytes) const;
+
+    uint32_t addEvictionCallback(EvictionCallback callback);
+    void removeEvictionCallback(uint32_t id);
+
+    void printBudget(std::ostream& out) const;
+
+    // Eviction starts above EVICTION_THRESHOLD of the budget and frees down to EVICTION_TARGET
+    static constexpr double EVICTION_THRESHOLD = 0.9;
+    static constexpr double EVICTION_TARGET = 0.8;
+    // Budget assumed without the extension, as a fraction of the heap size
+    static constexpr double ESTIMATED_BUDGET_FRACTION = 0.8;
+    // Frames to wait after evicting from a heap, so deferred deletions can land
+    static constexpr uint32_t EVICTION_COOLDOWN_FRAMES = 8;
+
+private:
+    void evict(uint32_t heapIndex, vk::DeviceSize bytesToFree);
+
+    vk::PhysicalDevice physicalDevice_;
+    MemoryAllocator& allocator_;
+    bool driverBudget_ = false;
+
+    mutable std::mutex mutex_; // Guards heaps_ and otherUsage_ (fits is called from allocating threads)
+    std::vector<HeapBudget> heaps_;
+    // Usage of each heap that is not ours (other processes, driver internals, ...)
+    std::vector<vk::DeviceSize> otherUsage_;
+    std::vector<uint32_t> evictionCooldown_;
+
+    struct Callback {
+        uint32_t id;
+        EvictionCallback callback;
+    };
+    std::vector<Callback> callbacks_;
+    uint32_t nextCallbackId_ = 1;
+};
+
+} // namespace VulkanEngine
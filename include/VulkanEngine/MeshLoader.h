@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanEngine {
+
+class JobSystem;
+
+// Vertex of an imported mesh
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec3 normal; // Computed from the triangles when the file has none
+    glm::vec3 color; // 1 when the file has none
+    glm::vec2 texCoord;
+};
+
+// Indexed triangle list, counter-clockwise front faces like OBJ and glTF
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    bool hasColors = false; // Vertex colors came from the file
+};
+
+struct MeshLoadStats {
+    size_t bytes = 0; // Size of the file
+    uint64_t triangles = 0;
+    uint32_t vertices = 0; // After deduplication
+    uint64_t corners = 0; // Triangle corners before deduplication
+    double parseMs = 0.0; // Text or binary to triangles, on all threads
+    double dedupMs = 0.0; // Hashing corners into unique vertices
+    double totalMs = 0.0; // Includes reading the file, if loadFile did
+
+    double getMegabytesPerSecond() const { return totalMs > 0.0 ? bytes / (1024.0 * 1024.0) / (totalMs / 1000.0) : 0.0; }
+    double getTrianglesPerSecond() const { return totalMs > 0.0 ? triangles / (totalMs / 1000.0) : 0.0; }
+};
+
+// Imports Wavefront OBJ and binary glTF 2.0 (.glb) into a MeshData, on all threads of the
+// job system.
+//  - OBJ: the text is split into chunks at line breaks and every chunk is parsed by its own
+//    job. Polygons are fanned into triangles, "v x y z r g b" vertex colors are read,
+//    negative (relative) indices are resolved once the chunks are joined. Materials,
+//    groups, lines and points are ignored.
+//  - glb: the triangle primitives of every mesh in the default scene, transformed by their
+//    nodes, are converted in parallel ranges. POSITION, NORMAL, COLOR_0 and TEXCOORD_0 are
+//    read; buffers have to be in the GLB's binary chunk.
+// Corners that end up with identical attributes become one vertex through a hash map, so a
+// mesh of n triangles usually comes out with about n / 2 vertices.
+//
+// Malformed files throw std::runtime_error.
+class MeshLoader {
+public:
+    explicit MeshLoader(JobSystem& jobSystem);
+
+    // Prevent copying
+    MeshLoader(const MeshLoader&) = delete;
+    MeshLoader& operator=(const MeshLoader&) = delete;
+
+    // Format by extension, .obj or .glb
+    MeshData loadFile(const std::string& path);
+    // data has to stay valid during the call only. name picks the format by its extension.
+    MeshData load(const void* data, size_t size, const std::string& name);
+    MeshData loadObj(const void* data, size_t size);
+    MeshData loadGlb(const void* data, size_t size);
+
+    // Of the last load
+    const MeshLoadStats& getStats() const { return stats_; }
+
+    static constexpr size_t OBJ_CHUNK_BYTES = 1024 * 1024; // Text per parse job
+    static constexpr uint32_t GLB_BATCH_VERTICES = 64 * 1024; // Vertices per conversion job
+
+private:
+    // Merges corners with the same key. hashes[corner] has to be filled; equal(a, b)
+    // compares two corners. Returns the vertex of every corner and fills firstCorners with
+    // the corner each vertex was first seen at.
+    template <typename Equal>
+    static std::vector<uint32_t> deduplicate(const std::vector<uint64_t>& hashes, Equal equal,
+                                             std::vector<uint32_t>& firstCorners);
+    static void computeNormals(MeshData& mesh);
+
+    JobSystem& jobSystem_;
+    MeshLoadStats stats_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+// One level of detail: a range of a mesh's index buffer, and how far (object space units)
+// its surface may be from the full detail one
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+};
+
+// Discrete LODs of one mesh, all indexing the same vertices. lods[0] is the input mesh;
+// each further level has about half the triangles of the one before and a larger error.
+struct LodChain {
+    std::vector<uint32_t> indices; // Every level, back to back
+    std::vector<MeshLod> lods; // firstIndex into indices
+
+    static constexpr uint32_t MAX_LODS = 8;
+
+    // Simplifies with MeshSimplifier until a level would drop below minTriangles, stops
+    // shrinking, or exceeds maxError
+    static LodChain build(const float* positions, size_t vertexCount, size_t stride, const std::vector<uint32_t>& indices,
+                          uint32_t minTriangles = 16, float maxError = 1e30f);
+};
+
+// Runtime selection by projected screen space error.
+// A coarser level is taken once its error shrinks to LOD_HYSTERESIS of the LOD_PIXEL_ERROR
+// budget, and only given up when it exceeds the whole budget, so objects near a threshold
+// don't flicker between levels. shaders/cull.comp does the same.
+constexpr float LOD_PIXEL_ERROR = 1.0f;
+constexpr float LOD_HYSTERESIS = 0.75f;
+constexpr float LOD_MIN_DISTANCE = 0.1f; // The camera's near plane, closer is full detail anyway
+
+// Size on screen, in pixels, of one object space unit.
+// projScale: viewport height / (2 tan(fovy / 2)); scale: the object's largest axis scale;
+// distance: from the eye to the nearest point of the object's bounding sphere
+inline float getPixelsPerUnit(float projScale, float scale, float distance) {
+    return projScale * scale / std::max(distance, LOD_MIN_DISTANCE);
+}
+
+// currentLod: the level selected for the object last frame
+inline uint32_t selectLod(const MeshLod* lods, uint32_t lodCount, uint32_t currentLod, float pixelsPerUnit) {
+    uint32_t lod = currentLod < lodCount ? currentLod : lodCount - 1;
+    while (lod > 0 && lods[lod].error * pixelsPerUnit > LOD_PIXEL_ERROR) {
+        lod--;
+    }
+    while (lod + 1 < lodCount && lods[lod + 1].error * pixelsPerUnit <= LOD_PIXEL_ERROR * LOD_HYSTERESIS) {
+        lod++;
+    }
+    return lod;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+// Quadric error metric simplifier (Garland & Heckbert) for building LOD chains ahead of
+// rendering.
+// Collapses edges onto one of their existing vertices, so every level indexes the original
+// vertex buffer and the levels of a mesh can share it. Each simplify() call continues from
+// the previous result, which makes a chain cost little more than its first level.
+//
+// Vertices on open borders and attribute seams (several vertices at one position) never
+// move, so outlines and UV/normal splits survive. The error is the largest root mean
+// square distance, in object space units, between a collapsed vertex and the planes of
+// the triangles it replaced.
+class MeshSimplifier {
+public:
+    // positions: vertexCount float3 positions, stride bytes apart
+    MeshSimplifier(const float* positions, size_t vertexCount, size_t stride, std::vector<uint32_t> indices);
+
+    // Collapses edges, cheapest first, until at most targetIndexCount indices are left or
+    // the next collapse would exceed maxError. Returns the current index buffer.
+    const std::vector<uint32_t>& simplify(size_t targetIndexCount, float maxError);
+
+    const std::vector<uint32_t>& getIndices() const { return indices_; }
+    float getError() const;
+
+private:
+    struct Quadric {
+        // Symmetric 4x4 matrix, upper triangle, and the total area that went into it
+        double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+        double weight;
+
+        void add(const Quadric& other);
+        double evaluate(const glm::vec3& point) const;
+    };
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    void addTriangleQuadrics();
+    bool isValidCollapse(uint32_t from, uint32_t to, const std::vector<uint32_t>& adjacencyOffsets,
+                         const std::vector<uint32_t>& adjacency) const;
+
+    std::vector<glm::vec3> positions_;
+    std::vector<uint32_t> indices_;
+    std::vector<uint32_t> positionIds_; // [vertex] first vertex with the same position
+    std::vector<uint8_t> locked_; // [vertex], border or seam
+    std::vector<Quadric> quadrics_; // [position id]
+    double maxCost_ = 0.0;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <vector>
+
+#include "VulkanEngine/JobSystem.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Records a draw list into secondary command buffers as JobSystem jobs.
+// Every job system thread has its own command pool per frame in flight (pools are
+// externally synchronized, so they cannot be shared), which is reset wholesale in
+// beginFrame. record() splits the items into contiguous ranges and returns the
+// secondaries in item order, ready for vkCmdExecuteCommands on the primary.
+class ParallelRecorder {
+public:
+    // Records items [begin, end) into commandBuffer. Called concurrently from several threads.
+    using RecordFunction = std::function<void(vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+
+    ParallelRecorder(VulkanDevice& device, JobSystem& jobSystem, uint32_t framesInFlight);
+    ~ParallelRecorder();
+
+    // Prevent copying
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+    // Resets frameIndex's pools. The frame's previous submission must have completed.
+    void beginFrame(uint32_t frameIndex);
+
+    std::vector<vk::CommandBuffer> record(const vk::CommandBufferInheritanceInfo& inheritance, uint32_t itemCount,
+                                          const RecordFunction& recordFunction);
+
+    uint32_t getThreadCount() const { return jobSystem_.getThreadCount(); }
+
+    // Below this many items per job the split costs more than it saves
+    static constexpr uint32_t MIN_ITEMS_PER_TASK = 256;
+
+private:
+    struct ThreadPool {
+        vk::CommandPool pool = nullptr;
+        std::vector<vk::CommandBuffer> buffers;
+        uint32_t used = 0; // Buffers handed out this frame
+    };
+
+    // Runs on whichever thread picked up the job, and records into that thread's pool
+    vk::CommandBuffer recordRange(const vk::CommandBufferInheritanceInfo& inheritance, uint32_t begin, uint32_t end,
+                                  const RecordFunction& recordFunction);
+
+    vk::Device device_;
+    JobSystem& jobSystem_;
+    std::vector<std::vector<ThreadPool>> pools_; // [frame][job system thread]
+    uint32_t frameIndex_ = 0;
+};
+
+} // namespace VulkanEngine
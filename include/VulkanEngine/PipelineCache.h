@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+
+#include "VulkanEngine/AssetBundle.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// VkPipelineCache persisted to a file between runs.
+// The file is the driver's cache blob. Its header (vendor, device ID, pipelineCacheUUID) is
+// checked against the current device before the data is handed to the driver, since a blob
+// from another GPU or driver version is useless at best. save() writes to a temporary
+// file and renames it over the old one, so a crash mid-write never leaves a torn cache.
+// Without a usable file, a seed blob (e.g. shipped in the asset bundle) goes through the
+// same checks.
+class PipelineCache {
+public:
+    PipelineCache(VulkanDevice& device, const std::string& path, AssetView seed = {});
+    ~PipelineCache();
+
+    // Prevent copying
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    vk::PipelineCache get() const { return cache_; }
+    // True if a valid file or seed was loaded, i.e. pipeline creation should mostly hit the cache
+    bool isWarm() const { return loadedBytes_ > 0; }
+    size_t getLoadedBytes() const { return loadedBytes_; }
+
+    // Writes the current cache contents to disk. Returns false (and warns) on failure.
+    bool save() const;
+
+private:
+    std::vector<char> loadFile() const;
+    bool isValid(const char* data, size_t size, const std::string& source) const;
+
+    vk::Device device_;
+    vk::PhysicalDeviceProperties properties_;
+    std::string path_;
+    vk::PipelineCache cache_ = nullptr;
+    size_t loadedBytes_ = 0;
+};
+
+} // namespace VulkanEngine
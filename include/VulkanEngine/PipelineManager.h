@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "VulkanEngine/JobSystem.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+class PipelineCache;
+
+enum class BlendMode : uint8_t {
+    eOpaque,
+    eAlpha,    // src * a + dst * (1 - a)
+    eAdditive  // src * a + dst
+};
+
+// Everything that varies between graphics pipelines, packed into a small value type.
+// Shaders and vertex layouts are referred to by the ids PipelineManager hands out.
+// Render pass pipelines use the render pass registered for the key's formats.
+struct PipelineKey {
+    uint32_t vertexShader = 0;
+    uint32_t fragmentShader = 0;
+    uint32_t vertexLayout = 0;
+    vk::Format colorFormat = vk::Format::eUndefined;
+    vk::Format depthFormat = vk::Format::eUndefined;
+    vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+    vk::PolygonMode polygonMode = vk::PolygonMode::eFill;
+    vk::CullModeFlags cullMode = vk::CullModeFlagBits::eBack;
+    vk::FrontFace frontFace = vk::FrontFace::eClockwise;
+    BlendMode blend = BlendMode::eOpaque;
+    bool depthTest = true;
+    bool depthWrite = true;
+    vk::CompareOp depthCompare = vk::CompareOp::eLess;
+
+    bool operator==(const PipelineKey& other) const;
+    bool operator!=(const PipelineKey& other) const { return !(*this == other); }
+};
+
+struct PipelineKeyHash {
+    size_t operator()(const PipelineKey& key) const;
+};
+
+// Owns every graphics pipeline, one per distinct PipelineKey, sharing one pipeline layout.
+// get() never compiles on the calling thread: a missing variant is queued as a background
+// job, which only the JobSystem's workers run, and the caller gets the fallback pipeline
+// until it is done, so a new material costs a frame or two of the fallback look instead of
+// a hitch. Compiles go through the PipelineCache, which the driver synchronizes internally.
+//
+// Pipelines are destroyed with the manager. Callers must have waited for the GPU by then.
+class PipelineManager {
+public:
+    using ShaderId = uint32_t;
+    using VertexLayoutId = uint32_t;
+
+    PipelineManager(VulkanDevice& device, JobSystem& jobSystem, PipelineCache& cache, vk::PipelineLayout layout);
+    ~PipelineManager();
+
+    // Prevent copying
+    PipelineManager(const PipelineManager&) = delete;
+    PipelineManager& operator=(const PipelineManager&) = delete;
+
+    // Loads SPIR-V from path. Ids are never reused.
+    ShaderId loadShader(const std::string& path, vk::ShaderStageFlagBits stage);
+    // SPIR-V already in memory (e.g. an asset bundle mapping), 4-byte aligned. name is for messages.
+    ShaderId loadShader(const std::string& name, const void* code, size_t size, vk::ShaderStageFlagBits stage);
+    // Replaces the shader's code with the SPIR-V at path and recompiles every pipeline using it
+    // in the background. Until a recompile is done, get() keeps returning the old pipeline.
+    // Throws (leaving everything as it was) if the new code can't be loaded.
+    void reloadShader(ShaderId shader, const std::string& path);
+    // Pipelines replaced by recompiles since the last call. The caller destroys them once
+    // no frame in flight uses them anymore.
+    std::vector<vk::Pipeline> takeReplacedPipelines();
+    VertexLayoutId addVertexLayout(std::vector<vk::VertexInputBindingDescription> bindings,
+                                   std::vector<vk::VertexInputAttributeDescription> attributes);
+    // Render pass used for keys with these formats when dynamic rendering is off. Takes ownership.
+    void addRenderPass(vk::Format colorFormat, vk::Format depthFormat, vk::RenderPass renderPass);
+    // nullptr if none was added for these formats
+    vk::RenderPass getRenderPass(vk::Format colorFormat, vk::Format depthFormat) const;
+
+    // The pipeline for key if it is compiled, otherwise starts compiling it and returns
+    // fallback's pipeline, compiling that one on the spot if needed. Render thread only.
+    vk::Pipeline get(const PipelineKey& key, const PipelineKey& fallback);
+    // Compiles key on the calling thread if needed, or waits for its queued compile. For
+    // startup and fallbacks.
+    vk::Pipeline getBlocking(const PipelineKey& key);
+    // Queues a compile for key unless it is compiled or compiling already
+    void request(const PipelineKey& key);
+
+    // Compute pipeline for shader with its own layout, compiled on the calling thread.
+    // Owned by the manager; not recompiled by reloadShader.
+    vk::Pipeline createComputePipeline(ShaderId shader, vk::PipelineLayout layout);
+
+    // Waits for all queued compiles
+    void waitIdle();
+
+    vk::PipelineLayout getLayout() const { return layout_; }
+    size_t getPipelineCount() const;
+    size_t getPendingCount() const;
+
+private:
+    enum class State { ePending, eReady, eFailed };
+    struct Entry {
+        State state = State::ePending;
+        vk::Pipeline pipeline = nullptr;
+    };
+    struct Shader {
+        std::string path;
+        vk::ShaderStageFlagBits stage;
+        vk::ShaderModule module = nullptr;
+    };
+    struct VertexLayout {
+        std::vector<vk::VertexInputBindingDescription> bindings;
+        std::vector<vk::VertexInputAttributeDescription> attributes;
+    };
+
+    vk::Pipeline compile(const PipelineKey& key) const;
+    void compileAsync(const PipelineKey& key); // mutex_ must be held
+    void recompileAsync(const PipelineKey& key); // mutex_ must be held
+    static std::vector<uint32_t> readSpirv(const std::string& path);
+
+    vk::Device device_;
+    JobSystem& jobSystem_;
+    PipelineCache& cache_;
+    vk::PipelineLayout layout_;
+    bool dynamicRendering_;
+
+    mutable std::mutex mutex_; // Guards everything below except compiles_, compile jobs read shaders and layouts too
+    std::condition_variable compiled_; // Signaled whenever an entry leaves ePending
+    std::unordered_map<PipelineKey, Entry, PipelineKeyHash> entries_;
+    std::vector<Shader> shaders_;
+    std::vector<VertexLayout> vertexLayouts_;
+    std::map<std::pair<vk::Format, vk::Format>, vk::RenderPass> renderPasses_;
+    std::vector<vk::RenderPass> retiredRenderPasses_; // Replaced by addRenderPass, kept until destruction
+    std::vector<vk::Pipeline> replacedPipelines_; // Swapped out by recompiles, see takeReplacedPipelines
+    std::vector<vk::Pipeline> computePipelines_;
+    JobSystem::Counter compiles_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "VulkanEngine/MemoryAllocator.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+enum class PassType {
+    eGraphics,
+    eCompute,
+    eTransfer
+};
+
+// How a pass touches a resource. Stages, access masks and image layouts are derived from this.
+enum class ResourceUsage {
+    eColorAttachment,
+    eDepthAttachment,
+    eDepthRead,      // Depth test without writes / depth as read-only attachment
+    eSampled,        // Sampled image or read-only storage buffer in shaders
+    eStorageRead,
+    eStorageWrite,
+    eUniform,
+    eVertexBuffer,
+    eIndexBuffer,
+    eIndirect,
+    eTransferSrc,
+    eTransferDst
+};
+
+struct ImageDesc {
+    vk::Format format = vk::Format::eUndefined;
+    vk::Extent2D extent;
+    vk::ImageUsageFlags usage;
+    vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+};
+
+struct BufferDesc {
+    vk::DeviceSize size = 0;
+    vk::BufferUsageFlags usage;
+};
+
+// Where an imported resource is picked up from and handed back to outside the graph
+struct ResourceState {
+    vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eTopOfPipe;
+    vk::AccessFlags access;
+};
+
+// Frame graph: passes declare what they read and write, compile() works out the rest.
+//  - Passes that contribute nothing to an imported resource (or are not marked with
+//    sideEffects) are culled.
+//  - Barriers are derived from the declared usages and batched into one
+//    vkCmdPipelineBarrier per pass; reads that are already visible get none.
+//  - Transient resources (createImage/createBuffer) are owned by the graph. Their memory
+//    is packed so that resources whose lifetimes do not overlap share the same bytes.
+//
+// The graph is built and compiled once (and rebuilt when sizes change); execute() is
+// called every frame. Imported resources such as the swapchain image can be swapped
+// per frame with setImportedImage.
+class RenderGraph {
+public:
+    using ResourceHandle = uint32_t;
+    using ExecuteCallback = std::function<void(vk::CommandBuffer)>;
+    static constexpr ResourceHandle INVALID_RESOURCE = ~0u;
+
+    class PassBuilder {
+    public:
+        PassBuilder& read(ResourceHandle resource, ResourceUsage usage);
+        PassBuilder& write(ResourceHandle resource, ResourceUsage usage);
+        // Never culled, even if nothing reads what it writes
+        PassBuilder& sideEffects();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+        RenderGraph& graph_;
+        uint32_t pass_;
+    };
+
+    struct CompileStats {
+        uint32_t passCount = 0;
+        uint32_t culledPassCount = 0;
+        uint32_t barrierCount = 0;       // Individual image/buffer barriers
+        uint32_t barrierBatchCount = 0;  // vkCmdPipelineBarrier calls
+        vk::DeviceSize transientBytes = 0; // Memory actually allocated for transients
+        vk::DeviceSize unaliasedBytes = 0; // What the transients would need without aliasing
+    };
+
+    RenderGraph(VulkanDevice& device, MemoryAllocator& allocator);
+    ~RenderGraph();
+
+    // Prevent copying
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    ResourceHandle importImage(const std::string& name, const ImageDesc& desc,
+                               const ResourceState& initialState, const ResourceState& finalState);
+    ResourceHandle importBuffer(const std::string& name, vk::Buffer buffer, const BufferDesc& desc,
+                                const ResourceState& initialState, const ResourceState& finalState);
+    void setImportedImage(ResourceHandle resource, vk::Image image, vk::ImageView view);
+    void setImportedBuffer(ResourceHandle resource, vk::Buffer buffer);
+
+    // Transient resources, contents are undefined at the start of every frame
+    ResourceHandle createImage(const std::string& name, const ImageDesc& desc);
+    ResourceHandle createBuffer(const std::string& name, const BufferDesc& desc);
+
+    PassBuilder addPass(const std::string& name, PassType type, ExecuteCallback execute);
+
+    void compile();
+    void execute(vk::CommandBuffer commandBuffer);
+
+    vk::Image getImage(ResourceHandle resource) const { return resources_[resource].image; }
+    vk::ImageView getImageView(ResourceHandle resource) const { return resources_[resource].view; }
+    vk::Buffer getBuffer(ResourceHandle resource) const { return resources_[resource].buffer; }
+
+    const CompileStats& getStats() const { return stats_; }
+    void printStats(std::ostream& out) const;
+
+private:
+    struct Resource {
+        std::string name;
+        bool isImage = false;
+        bool imported = false;
+        ImageDesc imageDesc;
+        BufferDesc bufferDesc;
+        ResourceState initialState;
+        ResourceState finalState;
+
+        vk::Image image = nullptr;
+        vk::ImageView view = nullptr;
+        vk::Buffer buffer = nullptr;
+
+        // Transient placement, filled in by compile()
+        uint32_t firstPass = ~0u; // Index into executionOrder_
+        uint32_t lastPass = 0;
+        uint32_t aliasGroup = ~0u;
+        vk::MemoryRequirements requirements;
+        vk::DeviceSize memoryOffset = 0;
+    };
+
+    struct PassResource {
+        ResourceHandle resource;
+        ResourceUsage usage;
+        bool write;
+    };
+
+    struct Pass {
+        std::string name;
+        PassType type;
+        ExecuteCallback execute;
+        std::vector<PassResource> resources;
+        bool sideEffects = false;
+    };
+
+    struct Barrier {
+        ResourceHandle resource;
+        vk::PipelineStageFlags srcStage;
+        vk::PipelineStageFlags dstStage;
+        vk::AccessFlags srcAccess;
+        vk::AccessFlags dstAccess;
+        vk::ImageLayout oldLayout;
+        vk::ImageLayout newLayout;
+    };
+
+    // Transients sharing one allocation
+    struct AliasGroup {
+        bool isImage;
+        uint32_t memoryTypeBits;
+        vk::DeviceSize alignment = 1;
+        vk::DeviceSize size = 0;
+        std::vector<ResourceHandle> resources;
+        Allocation allocation;
+    };
+
+    struct UsageInfo {
+        vk::PipelineStageFlags stage;
+        vk::AccessFlags access;
+        vk::ImageLayout layout;
+    };
+    static UsageInfo getUsageInfo(ResourceUsage usage, PassType type);
+
+    void cullPasses(std::vector<bool>& live) const;
+    void allocateTransients();
+    void buildBarriers();
+    void recordBarriers(vk::CommandBuffer commandBuffer, const std::vector<Barrier>& barriers) const;
+
+    vk::Device device_;
+    MemoryAllocator& allocator_;
+
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+    bool compiled_ = false;
+
+    // Filled in by compile()
+    std::vector<uint32_t> executionOrder_;            // Live passes in declaration order
+    std::vector<std::vector<Barrier>> passBarriers_; // Barriers before each entry of executionOrder_
+    std::vector<Barrier> finalBarriers_;             // Hand imported resources back in their final state
+    std::vector<AliasGroup> aliasGroups_;
+    CompileStats stats_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VulkanEngine/PipelineManager.h"
+
+namespace VulkanEngine {
+
+// Development mode shader reloading.
+// A watcher thread notices edits to the GLSL sources (inotify on Linux, timestamp polling
+// elsewhere) and compiles them to SPIR-V with glslc itself, so a compile never lands on a
+// frame thread. poll() reports the shaders whose compile succeeded. The caller hands those
+// to PipelineManager::reloadShader between frames. A failed compile leaves the old SPIR-V
+// in place, and glslc's own output says what is wrong.
+class ShaderHotReload {
+public:
+    struct Reload {
+        PipelineManager::ShaderId shader;
+        std::string spirvPath;
+    };
+
+    ShaderHotReload(const std::string& sourceDir, const std::string& glslc);
+    ~ShaderHotReload();
+
+    // Prevent copying
+    ShaderHotReload(const ShaderHotReload&) = delete;
+    ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+    // sourceFile is relative to sourceDir. spirvPath is what the shader was loaded from and gets overwritten.
+    void watch(const std::string& sourceFile, const std::string& spirvPath, PipelineManager::ShaderId shader);
+
+    // Returns the shaders recompiled since the last call. Never blocks on a compile. Render
+    // thread only.
+    std::vector<Reload> poll();
+
+    // Editors often write a file in several steps, compile once it has been quiet this long
+    static constexpr std::chrono::milliseconds SETTLE_TIME{100};
+
+private:
+    struct Watched {
+        std::string spirvPath;
+        PipelineManager::ShaderId shader;
+    };
+    using Clock = std::chrono::steady_clock;
+
+    void watchLoop();
+    void markChanged(const std::string& sourceFile);
+    // Compiles the sources that have been quiet for SETTLE_TIME. Watcher thread only.
+    void compileSettled();
+    bool compile(const std::string& sourceFile, const std::string& spirvPath) const;
+
+    std::string sourceDir_;
+    std::string glslc_;
+
+    std::mutex mutex_; // Guards everything below
+    std::map<std::string, std::vector<Watched>> watched_; // [source file]
+    std::map<std::string, Clock::time_point> changed_; // Source file -> time of its last change
+    std::vector<Reload> finished_;
+
+    std::atomic<bool> stopping_{false};
+    std::thread watcher_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+
+#include "VulkanEngine/MemoryAllocator.h"
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Persistently mapped, host-visible ring buffer that every upload is staged through.
+// Writing data is a memcpy into the ring; space is handed back once the timeline value
+// of the submission that consumed it has been reached, so streaming needs no allocations.
+//
+// Usage:
+//   auto region = ring.upload(data, size);             // or allocate() and fill region.data
+//   ring.recordCopyToBuffer(cmd, region, dstBuffer);   // dst may be created after the upload
+//   UploadTicket ticket = transferQueue.submit(cmd);
+//   ring.closeSubmission(transferQueue.getTimeline(), ticket.value);
+class StagingRing {
+public:
+    // A mapped span of the ring
+    struct Region {
+        vk::Buffer buffer = nullptr; // The ring buffer itself
+        vk::DeviceSize offset = 0;   // Offset of the span in buffer
+        vk::DeviceSize size = 0;
+        void* data = nullptr;        // Mapped pointer to the span
+    };
+
+    StagingRing(VulkanDevice& device, MemoryAllocator& allocator, vk::DeviceSize size);
+    ~StagingRing();
+
+    // Prevent copying
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    // Reserves a span, waiting for older submissions to retire if the ring is full
+    Region allocate(vk::DeviceSize size, vk::DeviceSize alignment = DEFAULT_ALIGNMENT);
+    // allocate() + memcpy
+    Region upload(const void* data, vk::DeviceSize size, vk::DeviceSize alignment = DEFAULT_ALIGNMENT);
+
+    // Copy commands reading from a region
+    static void recordCopyToBuffer(vk::CommandBuffer commandBuffer, const Region& region, vk::Buffer dstBuffer, vk::DeviceSize dstOffset = 0);
+    // copy.bufferOffset is relative to the region; dstImage must already be in dstLayout
+    static void recordCopyToImage(vk::CommandBuffer commandBuffer, const Region& region, vk::Image dstImage,
+                                  vk::ImageLayout dstLayout, vk::BufferImageCopy copy);
+
+    // Ends the current submission. Everything allocated since the previous call is
+    // reclaimed once timeline reaches value, which must be signaled by the submit that
+    // executes the copies.
+    void closeSubmission(vk::Semaphore timeline, uint64_t value);
+    // Frees the space of submissions that have completed
+    void reclaim();
+
+    vk::DeviceSize getSize() const { return size_; }
+    vk::DeviceSize getUsedBytes() const { return head_ - tail_; }
+
+    static constexpr vk::DeviceSize DEFAULT_ALIGNMENT = 16;
+    static constexpr vk::DeviceSize MAX_ALIGNMENT = 64 * 1024; // The ring size is kept a multiple of this
+
+private:
+    struct Submission {
+        vk::Semaphore timeline;
+        uint64_t value;
+        uint64_t end; // head_ when the submission was closed
+    };
+
+    VulkanDevice& vulkanDevice_;
+    MemoryAllocator& allocator_;
+    vk::Device device_;
+
+    vk::Buffer buffer_ = nullptr;
+    Allocation allocation_;
+    vk::DeviceSize size_;
+
+    // Monotonic byte positions, the physical offset is position % size_
+    uint64_t head_ = 0; // Next free byte
+    uint64_t tail_ = 0; // Oldest byte still in use by the GPU
+
+    std::deque<Submission> inFlight_;
+};
+
+} // namespace VulkanEngine
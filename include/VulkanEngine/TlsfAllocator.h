@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+// Two-Level Segregated Fit sub-allocator over a linear range of offsets.
+// It only hands out offsets, so it knows nothing about Vulkan; MemoryAllocator
+// uses one instance per VkDeviceMemory block.
+// Allocation and free are O(1): free ranges are bucketed by size class and
+// looked up through two bitmaps, and neighbours are merged on free.
+class TlsfAllocator {
+public:
+    static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+    explicit TlsfAllocator(uint64_t size);
+
+    // Returns INVALID_NODE if no free range can hold size bytes at the given alignment
+    // (alignment must be a power of two).
+    uint32_t allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset);
+    void free(uint32_t node);
+
+    uint64_t getSize() const { return size_; }
+    uint64_t getUsedBytes() const { return usedBytes_; }
+    uint32_t getAllocationCount() const { return allocationCount_; }
+    bool isEmpty() const { return allocationCount_ == 0; }
+
+private:
+    // Second level splits each power-of-two range into 32 linear size classes
+    static constexpr uint32_t SL_INDEX_COUNT_LOG2 = 5;
+    static constexpr uint32_t SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+    // Everything below SMALL_BLOCK_SIZE lives in first level 0
+    static constexpr uint32_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + 3;
+    static constexpr uint64_t SMALL_BLOCK_SIZE = 1ull << FL_INDEX_SHIFT;
+    static constexpr uint32_t FL_INDEX_MAX = 40; // Blocks up to 1 TiB
+    static constexpr uint32_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    // Leftovers smaller than this stay attached to the allocation instead of being split off
+    static constexpr uint64_t MIN_SPLIT_SIZE = 16;
+
+    struct Node {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t prevPhysical = INVALID_NODE;
+        uint32_t nextPhysical = INVALID_NODE;
+        uint32_t prevFree = INVALID_NODE;
+        uint32_t nextFree = INVALID_NODE;
+        bool isFree = false;
+    };
+
+    static void mappingInsert(uint64_t size, uint32_t& fl, uint32_t& sl);
+    static void mappingSearch(uint64_t size, uint32_t& fl, uint32_t& sl);
+    uint32_t findFreeNode(uint32_t& fl, uint32_t& sl) const;
+    uint32_t findFreeNodeInClass(uint64_t size, uint64_t alignment) const;
+
+    uint32_t newNode();
+    void releaseNode(uint32_t node);
+    void insertFree(uint32_t node);
+    void removeFree(uint32_t node);
+    // Splits the tail of node into a new free node starting at offset + keepSize
+    void splitTail(uint32_t node, uint64_t keepSize);
+    void mergeWithNext(uint32_t node);
+
+    uint64_t size_;
+    uint64_t usedBytes_ = 0;
+    uint32_t allocationCount_ = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> unusedNodes_;
+
+    uint64_t flBitmap_ = 0;
+    std::array<uint32_t, FL_INDEX_COUNT> slBitmaps_{};
+    std::array<std::array<uint32_t, SL_INDEX_COUNT>, FL_INDEX_COUNT> freeHeads_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace VulkanEngine {
+
+class VulkanDevice;
+
+// Completion handle of an upload: done once the transfer timeline reaches value
+struct UploadTicket {
+    uint64_t value = 0;
+};
+
+// Asynchronous upload path on the transfer queue (a dedicated DMA family when the device
+// has one). Submissions never block the CPU; each one signals the next value of a timeline
+// semaphore, which the graphics submit waits on before using the uploaded data.
+//
+// When the transfer and graphics families differ, exclusive resources written here are
+// released with a queue family ownership barrier; the matching acquire is recorded into
+// the next frame's command buffer by recordAcquires().
+//
+// Not thread-safe: record and submit uploads from the main thread.
+class TransferQueue {
+public:
+    explicit TransferQueue(VulkanDevice& device);
+    ~TransferQueue();
+
+    // Prevent copying
+    TransferQueue(const TransferQueue&) = delete;
+    TransferQueue& operator=(const TransferQueue&) = delete;
+
+    // Returns a recording command buffer from the transfer pool
+    vk::CommandBuffer begin();
+    // Ends and submits without waiting
+    UploadTicket submit(vk::CommandBuffer commandBuffer);
+
+    // Record after the copies into the resource. dstStage/dstAccess describe how the
+    // graphics queue will read it.
+    void releaseBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size,
+                       vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+    void releaseImage(vk::CommandBuffer commandBuffer, vk::Image image, const vk::ImageSubresourceRange& range,
+                      vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+                      vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+    // Records the acquire half of every submitted release into a graphics command buffer.
+    // Returns the timeline value the graphics submit has to wait for (0 if there is nothing
+    // new to wait for) and the stages that wait belongs to.
+    uint64_t recordAcquires(vk::CommandBuffer graphicsCommandBuffer, vk::PipelineStageFlags& waitStages);
+
+    bool isComplete(UploadTicket ticket) const;
+    void wait(UploadTicket ticket) const;
+
+    vk::Semaphore getTimeline() const { return timeline_; }
+    uint64_t getCompletedValue() const;
+    bool needsOwnershipTransfer() const { return transferFamily_ != graphicsFamily_; }
+
+private:
+    struct InFlightCommandBuffer {
+        vk::CommandBuffer commandBuffer;
+        uint64_t value;
+    };
+
+    void recycleCommandBuffers();
+
+    vk::Device device_;
+    vk::Queue queue_;
+    uint32_t transferFamily_;
+    uint32_t graphicsFamily_;
+
+    vk::CommandPool commandPool_ = nullptr;
+    std::vector<vk::CommandBuffer> freeCommandBuffers_;
+    std::deque<InFlightCommandBuffer> inFlight_;
+
+    vk::Semaphore timeline_ = nullptr;
+    uint64_t lastSubmittedValue_ = 0;
+    uint64_t lastAcquiredValue_ = 0; // Highest value handed out by recordAcquires
+
+    // Acquire barriers for releases recorded into the command buffer being built,
+    // and for releases that were already submitted
+    std::vector<vk::BufferMemoryBarrier> recordingBufferAcquires_;
+    std::vector<vk::ImageMemoryBarrier> recordingImageAcquires_;
+    vk::PipelineStageFlags recordingAcquireStages_;
+    std::vector<vk::BufferMemoryBarrier> submittedBufferAcquires_;
+    std::vector<vk::ImageMemoryBarrier> submittedImageAcquires_;
+    vk::PipelineStageFlags submittedAcquireStages_;
+};
+
+} // namespace VulkanEngine
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+#include "VulkanEngine/StagingRing.h"
+#include "VulkanEngine/TransferQueue.h"
+
+namespace VulkanEngine {
+
+// Collects uploads during a frame or load phase and submits them together.
+// flush() records every queued copy into one transfer command buffer with a single submit,
+// merging buffer copies that are contiguous in both source and destination, and issues one
+// ownership release per destination resource.
+class UploadBatcher {
+public:
+    struct FlushStats {
+        uint32_t copiesQueued = 0;   // Buffer copies handed to the batcher
+        uint32_t copiesRecorded = 0; // Buffer copies left after merging
+        uint32_t copiesMerged = 0;   // copiesQueued - copiesRecorded
+        uint32_t imageCopies = 0;
+        vk::DeviceSize bytes = 0;
+        UploadTicket ticket;         // value 0 if there was nothing to flush
+    };
+
+    UploadBatcher(TransferQueue& transferQueue, StagingRing& stagingRing);
+
+    // Prevent copying
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+
+    // Queue a copy from data that is already in a buffer (usually the staging ring).
+    // dstStage/dstAccess describe how the graphics queue will read dstBuffer.
+    void enqueueCopy(vk::Buffer srcBuffer, vk::Buffer dstBuffer, const vk::BufferCopy& region,
+                     vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+    // Stage data into the ring and queue its copy
+    void enqueueBufferUpload(const void* data, vk::DeviceSize size, vk::Buffer dstBuffer, vk::DeviceSize dstOffset,
+                             vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+    // copy.bufferOffset is relative to data. The image is moved from eUndefined to
+    // eTransferDstOptimal for the copy and ends up in finalLayout.
+    void enqueueImageUpload(const void* data, vk::DeviceSize size, vk::Image dstImage,
+                            const vk::BufferImageCopy& copy, const vk::ImageSubresourceRange& range,
+                            vk::ImageLayout finalLayout, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+    FlushStats flush();
+    bool empty() const { return bufferCopies_.empty() && imageCopies_.empty(); }
+
+private:
+    struct PendingBufferCopy {
+        vk::Buffer src;
+        vk::Buffer dst;
+        vk::BufferCopy region;
+        vk::PipelineStageFlags dstStage;
+        vk::AccessFlags dstAccess;
+    };
+    struct PendingImageCopy {
+        vk::Buffer src;
+        vk::Image dst;
+        vk::BufferImageCopy copy;
+        vk::ImageSubresourceRange range;
+        vk::ImageLayout finalLayout;
+        vk::PipelineStageFlags dstStage;
+        vk::AccessFlags dstAccess;
+    };
+
+    // Keeps staged-but-unsubmitted data from filling the ring
+    void flushIfStagingFull(vk::DeviceSize incomingBytes);
+
+    TransferQueue& transferQueue_;
+    StagingRing& stagingRing_;
+
+    std::vector<PendingBufferCopy> bufferCopies_;
+    std::vector<PendingImageCopy> imageCopies_;
+    vk::DeviceSize stagedBytes_ = 0;
+};
+
+} // namespace VulkanEngine
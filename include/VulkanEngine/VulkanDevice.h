@@ -20,6 +20,8 @@ namespace VulkanEngine {
 struct QueueFamilyIndices { // Keep definition here
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Prefers a transfer-only family (DMA engine), falls back to graphicsFamily
+    std::optional<uint32_t> transferFamily;
 
     bool isComplete() const {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -50,11 +52,22 @@ public:
     vk::Device getDevice() const { return device_; }
     vk::Queue getGraphicsQueue() const { return graphicsQueue_; }
     vk::Queue getPresentQueue() const { return presentQueue_; }
+    vk::Queue getTransferQueue() const { return transferQueue_; }
+    bool hasDedicatedTransferQueue() const { return queueFamilyIndices_.transferFamily != queueFamilyIndices_.graphicsFamily; }
     vk::SurfaceKHR getSurface() const { return surface_; }
     bool validationLayersEnabled() const { return enableValidationLayers_; }
     QueueFamilyIndices getQueueFamilyIndices() const { return queueFamilyIndices_; }
     vk::DebugUtilsMessengerEXT getDebugMessenger() const { return debugMessenger_; }
     vk::Format findDepthFormat() const;
+    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const;
+    // True for required extensions and for optional ones the device supports
+    bool isExtensionEnabled(const std::string& name) const;
+    // Core dynamic rendering (Vulkan 1.3), enabled when the device supports it
+    bool hasDynamicRendering() const { return dynamicRenderingEnabled_; }
+    // Descriptor indexing with update-after-bind storage buffer and sampled image arrays (Vulkan 1.2)
+    bool hasBindless() const { return bindlessEnabled_; }
+    // multiDrawIndirect and vkCmdDrawIndexedIndirectCount (Vulkan 1.2)
+    bool hasIndirectCount() const { return indirectCountEnabled_; }
 
     // --- Swap Chain Helpers (Moved from Engine) --- 
     SwapChainSupportDetails querySwapChainSupport() const; 
@@ -75,6 +88,7 @@ private:
     bool isDeviceSuitable(vk::PhysicalDevice physicalDevice) const;
     QueueFamilyIndices findQueueFamilies(vk::PhysicalDevice physicalDevice) const;
     bool checkDeviceExtensionSupport(vk::PhysicalDevice physicalDevice) const;
+    bool checkDeviceFeatureSupport(vk::PhysicalDevice physicalDevice) const;
     vk::Format findSupportedFormat(const std::vector<vk::Format>& candidates, vk::ImageTiling tiling, vk::FormatFeatureFlags features) const;
     // Overload for querySwapChainSupport taking device explicitly
     SwapChainSupportDetails querySwapChainSupport(vk::PhysicalDevice physicalDevice) const; 
@@ -90,6 +104,7 @@ private:
     vk::Device device_ = nullptr;
     vk::Queue graphicsQueue_ = nullptr;
     vk::Queue presentQueue_ = nullptr;
+    vk::Queue transferQueue_ = nullptr;
     QueueFamilyIndices queueFamilyIndices_; // Store the found indices
 
     // Keep layers/extensions definition here or pass via config
@@ -99,6 +114,14 @@ private:
      const std::vector<const char*> deviceExtensions_ = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
+    // Enabled when available, callers check isExtensionEnabled
+    const std::vector<const char*> optionalDeviceExtensions_ = {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+    };
+    std::set<std::string> enabledExtensions_;
+    bool dynamicRenderingEnabled_ = false;
+    bool bindlessEnabled_ = false;
+    bool indirectCountEnabled_ = false;
 };
 
 } // namespace VulkanEngine 
\ No newline at end of file
@@ -0,0 +1,37 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless variant of shader.vert: per-object data comes from the storage buffer array,
+// addressed by the indices in the push constants
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+struct InstanceData {
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+    InstanceData instances[];
+} objectBuffers[];
+
+layout(push_constant) uniform DrawPushConstants {
+    uint objectBuffer;
+    uint objectIndex;
+    uint texture;
+    uint pad;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    // gl_InstanceIndex includes firstInstance, so every instance of every draw gets its own object
+    InstanceData instance = objectBuffers[draw.objectBuffer].instances[draw.objectIndex + gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * instance.model * vec4(inPosition, 1.0);
+    fragColor = inColor * instance.color.rgb;
+}
@@ -1,16 +1,25 @@
 #version 450
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+struct InstanceData {
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, binding = 1) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
+    InstanceData instance = instances[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * instance.model * vec4(inPosition, 1.0);
+    fragColor = inColor * instance.color.rgb;
 }
@@ -0,0 +1,137 @@
+#include "VulkanEngine/AssetBundle.h"
+#include "VulkanEngine/AssetBundleFormat.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef VULKAN_ENGINE_EMBEDDED_ASSETS
+// Generated by tools/pack_assets: defines EMBEDDED_ASSETS, an array of {name, data, size}
+#include "EmbeddedAssets.inc"
+#endif
+
+namespace VulkanEngine {
+
+AssetBundle::AssetBundle(const std::string& path) : path_(path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open asset bundle: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map asset bundle: " + path);
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open asset bundle: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat asset bundle: " + path);
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map asset bundle: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(info.st_size);
+#endif
+
+    try {
+        validate();
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+AssetBundle::~AssetBundle() {
+    unmap();
+}
+
+void AssetBundle::unmap() {
+    if (!data_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(file_));
+#else
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+}
+
+void AssetBundle::validate() {
+    // Bounds are checked once here, so find() can trust the table
+    BundleHeader header;
+    if (size_ < sizeof(header)) {
+        throw std::runtime_error("Asset bundle is truncated: " + path_);
+    }
+    std::memcpy(&header, data_, sizeof(header));
+    if (header.magic != BUNDLE_MAGIC || header.version != BUNDLE_VERSION) {
+        throw std::runtime_error("Not a version " + std::to_string(BUNDLE_VERSION) + " asset bundle: " + path_);
+    }
+    if (header.entryCount > (size_ - sizeof(header)) / sizeof(BundleEntry)) {
+        throw std::runtime_error("Asset bundle entry table is truncated: " + path_);
+    }
+
+    const uint8_t* table = data_ + sizeof(header);
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        BundleEntry entry;
+        std::memcpy(&entry, table + i * sizeof(BundleEntry), sizeof(entry));
+        entry.name[BUNDLE_NAME_SIZE - 1] = '\0';
+        if (entry.offset > size_ || entry.size > size_ - entry.offset || entry.offset % BUNDLE_ALIGNMENT != 0) {
+            throw std::runtime_error("Asset '" + std::string(entry.name) + "' is out of bounds in " + path_);
+        }
+        entries_[entry.name] = {data_ + entry.offset, static_cast<size_t>(entry.size)};
+    }
+}
+
+AssetView AssetBundle::find(const std::string& name) const {
+    auto it = entries_.find(name);
+    return it != entries_.end() ? it->second : AssetView{};
+}
+
+AssetView AssetBundle::findEmbedded(const std::string& name) {
+#ifdef VULKAN_ENGINE_EMBEDDED_ASSETS
+    for (const EmbeddedAsset& asset : EMBEDDED_ASSETS) {
+        if (name == asset.name) {
+            return {asset.data, asset.size};
+        }
+    }
+#else
+    (void)name;
+#endif
+    return {};
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,113 @@
+#include "VulkanEngine/BindlessDescriptors.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace VulkanEngine {
+
+BindlessDescriptors::BindlessDescriptors(VulkanDevice& device, uint32_t maxStorageBuffers, uint32_t maxSampledImages)
+    : device_(device.getDevice())
+{
+    if (!device.hasBindless()) {
+        throw std::runtime_error("BindlessDescriptors: descriptor indexing is not enabled on this device");
+    }
+
+    auto properties = device.getPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+    const auto& limits = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+    // Both arrays are visible to every stage, so the per-stage limits apply as well.
+    // A few slots of the shared resource limit are left for the engine's regular sets.
+    uint32_t resourceLimit = limits.maxPerStageUpdateAfterBindResources > 16 ? limits.maxPerStageUpdateAfterBindResources - 16 : 0;
+    storageBuffers_.capacity = std::min({maxStorageBuffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                         limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers, resourceLimit / 2});
+    sampledImages_.capacity = std::min({maxSampledImages, limits.maxDescriptorSetUpdateAfterBindSampledImages,
+                                        limits.maxPerStageDescriptorUpdateAfterBindSampledImages, resourceLimit / 2});
+    if (storageBuffers_.capacity < maxStorageBuffers || sampledImages_.capacity < maxSampledImages) {
+        std::cerr << "[WARN] Bindless arrays clamped to " << storageBuffers_.capacity << " storage buffers and "
+                  << sampledImages_.capacity << " images by device limits" << std::endl;
+    }
+    if (storageBuffers_.capacity == 0 || sampledImages_.capacity == 0) {
+        throw std::runtime_error("BindlessDescriptors: device update-after-bind limits are too small");
+    }
+
+    vk::ShaderStageFlags stages = vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute;
+    std::array<vk::DescriptorSetLayoutBinding, 2> bindings = {
+        vk::DescriptorSetLayoutBinding(STORAGE_BUFFER_BINDING, vk::DescriptorType::eStorageBuffer, storageBuffers_.capacity, stages),
+        vk::DescriptorSetLayoutBinding(SAMPLED_IMAGE_BINDING, vk::DescriptorType::eCombinedImageSampler, sampledImages_.capacity, stages)
+    };
+    vk::DescriptorBindingFlags bindingFlag = vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::ePartiallyBound;
+    std::array<vk::DescriptorBindingFlags, 2> bindingFlags = {bindingFlag, bindingFlag};
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo(bindingFlags);
+    vk::DescriptorSetLayoutCreateInfo layoutInfo(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindings);
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layout_ = device_.createDescriptorSetLayout(layoutInfo);
+
+    std::array<vk::DescriptorPoolSize, 2> poolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, storageBuffers_.capacity),
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, sampledImages_.capacity)
+    };
+    vk::DescriptorPoolCreateInfo poolInfo(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes);
+    try {
+        pool_ = device_.createDescriptorPool(poolInfo);
+        set_ = device_.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(pool_, layout_)).front();
+    } catch (...) {
+        if (pool_) {
+            device_.destroyDescriptorPool(pool_);
+        }
+        device_.destroyDescriptorSetLayout(layout_);
+        throw;
+    }
+}
+
+BindlessDescriptors::~BindlessDescriptors() {
+    // The set goes with the pool
+    device_.destroyDescriptorPool(pool_);
+    device_.destroyDescriptorSetLayout(layout_);
+}
+
+uint32_t BindlessDescriptors::allocateSlot(SlotArray& slots, const char* what) {
+    if (!slots.freeList.empty()) {
+        uint32_t index = slots.freeList.back();
+        slots.freeList.pop_back();
+        return index;
+    }
+    if (slots.next == slots.capacity) {
+        throw std::runtime_error(std::string("BindlessDescriptors: out of ") + what + " slots (" +
+                                 std::to_string(slots.capacity) + ")");
+    }
+    return slots.next++;
+}
+
+uint32_t BindlessDescriptors::addStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = allocateSlot(storageBuffers_, "storage buffer");
+    vk::DescriptorBufferInfo bufferInfo(buffer, offset, range);
+    vk::WriteDescriptorSet write(set_, STORAGE_BUFFER_BINDING, index, vk::DescriptorType::eStorageBuffer, nullptr, bufferInfo, nullptr);
+    device_.updateDescriptorSets(write, nullptr);
+    return index;
+}
+
+uint32_t BindlessDescriptors::addSampledImage(vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = allocateSlot(sampledImages_, "sampled image");
+    vk::DescriptorImageInfo imageInfo(sampler, view, layout);
+    vk::WriteDescriptorSet write(set_, SAMPLED_IMAGE_BINDING, index, vk::DescriptorType::eCombinedImageSampler, imageInfo, nullptr, nullptr);
+    device_.updateDescriptorSets(write, nullptr);
+    return index;
+}
+
+void BindlessDescriptors::releaseStorageBuffer(uint32_t index) {
+    // The stale descriptor stays in the slot, partially bound arrays allow that as long as nothing reads it
+    std::lock_guard<std::mutex> lock(mutex_);
+    storageBuffers_.freeList.push_back(index);
+}
+
+void BindlessDescriptors::releaseSampledImage(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampledImages_.freeList.push_back(index);
+}
+
+} // namespace VulkanEngine
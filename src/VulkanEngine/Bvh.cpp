@@ -0,0 +1,509 @@
+#include "VulkanEngine/Bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace VulkanEngine {
+
+namespace {
+
+constexpr uint32_t NO_PARENT = UINT32_MAX;
+// Past this depth nodes split at the median, which bounds the depth for any input
+constexpr uint32_t SAH_MAX_DEPTH = 32;
+
+Aabb nodeBounds(const Bvh::Node& node) {
+    Aabb bounds;
+    bounds.min = node.min;
+    bounds.max = node.max;
+    return bounds;
+}
+
+// Entry distance of the ray into the box, FLT_MAX if it misses within maxDistance
+float intersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                   float maxDistance) {
+    glm::vec3 t0 = (min - origin) * inverseDirection;
+    glm::vec3 t1 = (max - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+// Tests the box against the planes in planeMask. Returns false if it is outside one of them,
+// otherwise clears the bits of the planes it is entirely inside of.
+bool classifyBox(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, uint32_t& planeMask) {
+    for (uint32_t p = 0; p < 6; p++) {
+        if (!(planeMask & (1u << p))) {
+            continue;
+        }
+        const glm::vec4& plane = frustum.planes[p];
+        glm::vec3 normal(plane);
+        // Corner furthest along the normal, and the one furthest against it
+        glm::vec3 positive(normal.x >= 0.0f ? max.x : min.x, normal.y >= 0.0f ? max.y : min.y, normal.z >= 0.0f ? max.z : min.z);
+        glm::vec3 negative(normal.x >= 0.0f ? min.x : max.x, normal.y >= 0.0f ? min.y : max.y, normal.z >= 0.0f ? min.z : max.z);
+        if (glm::dot(normal, positive) + plane.w < 0.0f) {
+            return false;
+        }
+        if (glm::dot(normal, negative) + plane.w >= 0.0f) {
+            planeMask &= ~(1u << p);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+struct Bvh::Builder {
+    // Objects are partitioned as these, so every pass over a node's objects reads memory in order
+    struct Reference {
+        Aabb box;
+        glm::vec3 center;
+        uint32_t object;
+    };
+    struct Bin {
+        Aabb bounds;
+        Aabb centers;
+        uint32_t count = 0;
+    };
+
+    std::vector<Reference> references;
+    Tree& tree;
+
+    uint32_t addNode(uint32_t parent) {
+        tree.nodes.push_back({});
+        tree.parents.push_back(parent);
+        return static_cast<uint32_t>(tree.nodes.size() - 1);
+    }
+
+    void makeLeaf(uint32_t index, uint32_t first, uint32_t count) {
+        tree.nodes[index].offset = first;
+        tree.nodes[index].count = count;
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t object = references[i].object;
+            tree.objects[i] = object;
+            tree.objectBounds[i] = references[i].box;
+            tree.objectSlots[object] = i;
+            tree.objectLeaves[object] = index;
+        }
+    }
+
+    static uint32_t binIndex(float center, float origin, float scale) {
+        return std::min(BIN_COUNT - 1, static_cast<uint32_t>((center - origin) * scale));
+    }
+
+    void computeBounds(uint32_t first, uint32_t count, Aabb& box, Aabb& centerBox) const {
+        for (uint32_t i = first; i < first + count; i++) {
+            box.grow(references[i].box);
+            centerBox.grow(references[i].center);
+        }
+    }
+
+    // Builds the subtree of objects [first, first + count) into the node at index.
+    // Children are added after it, left first, so the array comes out depth first.
+    // box and centerBox bound the objects and their centers; the bins already have them
+    // for the children, which saves a pass over the objects per node.
+    void build(uint32_t index, uint32_t first, uint32_t count, uint32_t depth, const Aabb& box, const Aabb& centerBox) {
+        Reference* begin = references.data() + first;
+        Reference* end = begin + count;
+        tree.nodes[index].min = box.min;
+        tree.nodes[index].max = box.max;
+
+        if (count == 1 || depth + 1 >= MAX_DEPTH) {
+            makeLeaf(index, first, count);
+            return;
+        }
+
+        glm::vec3 extent = centerBox.max - centerBox.min;
+        if (depth < SAH_MAX_DEPTH) {
+            // Best binned SAH split over all three axes, binned in one pass over the objects
+            std::array<std::array<Bin, BIN_COUNT>, 3> bins;
+            glm::vec3 scale(0.0f);
+            for (int axis = 0; axis < 3; axis++) {
+                if (extent[axis] > 0.0f) {
+                    scale[axis] = BIN_COUNT / extent[axis];
+                }
+            }
+            for (const Reference* reference = begin; reference != end; reference++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    Bin& bin = bins[axis][binIndex(reference->center[axis], centerBox.min[axis], scale[axis])];
+                    bin.bounds.grow(reference->box);
+                    bin.centers.grow(reference->center);
+                    bin.count++;
+                }
+            }
+
+            float bestCost = FLT_MAX;
+            int bestAxis = -1;
+            uint32_t bestSplit = 0;
+            for (int axis = 0; axis < 3; axis++) {
+                if (extent[axis] <= 0.0f) {
+                    continue;
+                }
+                // Area times count of everything right of each split plane, then sweep from the left
+                std::array<float, BIN_COUNT> rightCost{};
+                Aabb rightBox;
+                uint32_t rightCount = 0;
+                for (uint32_t split = BIN_COUNT - 1; split > 0; split--) {
+                    rightBox.grow(bins[axis][split].bounds);
+                    rightCount += bins[axis][split].count;
+                    rightCost[split] = rightCount > 0 ? rightBox.surfaceArea() * rightCount : 0.0f;
+                }
+                Aabb leftBox;
+                uint32_t leftCount = 0;
+                for (uint32_t split = 1; split < BIN_COUNT; split++) {
+                    leftBox.grow(bins[axis][split - 1].bounds);
+                    leftCount += bins[axis][split - 1].count;
+                    if (leftCount == 0 || leftCount == count) {
+                        continue;
+                    }
+                    float cost = leftBox.surfaceArea() * leftCount + rightCost[split];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            float area = box.surfaceArea();
+            if (bestAxis >= 0) {
+                float splitCost = area > 0.0f ? TRAVERSAL_COST + bestCost / area : TRAVERSAL_COST;
+                if (count <= MAX_LEAF_SIZE && splitCost >= static_cast<float>(count)) {
+                    makeLeaf(index, first, count);
+                    return;
+                }
+                // Same bin computation, so both sides get exactly their bins' objects
+                float origin = centerBox.min[bestAxis];
+                float axisScale = scale[bestAxis];
+                Reference* middle = std::partition(begin, end, [&](const Reference& reference) {
+                    return binIndex(reference.center[bestAxis], origin, axisScale) < bestSplit;
+                });
+                Aabb leftBox, leftCenters, rightBox, rightCenters;
+                for (uint32_t bin = 0; bin < BIN_COUNT; bin++) {
+                    (bin < bestSplit ? leftBox : rightBox).grow(bins[bestAxis][bin].bounds);
+                    (bin < bestSplit ? leftCenters : rightCenters).grow(bins[bestAxis][bin].centers);
+                }
+                split(index, first, count, static_cast<uint32_t>(middle - begin), depth, leftBox, leftCenters, rightBox, rightCenters);
+                return;
+            } else if (count <= MAX_LEAF_SIZE) {
+                // All centers in one place, splitting gains nothing
+                makeLeaf(index, first, count);
+                return;
+            }
+        } else if (count <= MAX_LEAF_SIZE) {
+            makeLeaf(index, first, count);
+            return;
+        }
+
+        // Median on the longest axis, always halves the node
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        Reference* middle = begin + count / 2;
+        std::nth_element(begin, middle, end, [axis](const Reference& a, const Reference& b) {
+            return a.center[axis] < b.center[axis];
+        });
+        uint32_t leftCount = count / 2;
+        Aabb leftBox, leftCenters, rightBox, rightCenters;
+        computeBounds(first, leftCount, leftBox, leftCenters);
+        computeBounds(first + leftCount, count - leftCount, rightBox, rightCenters);
+        split(index, first, count, leftCount, depth, leftBox, leftCenters, rightBox, rightCenters);
+    }
+
+    void split(uint32_t index, uint32_t first, uint32_t count, uint32_t leftCount, uint32_t depth,
+               const Aabb& leftBox, const Aabb& leftCenters, const Aabb& rightBox, const Aabb& rightCenters) {
+        uint32_t left = addNode(index);
+        build(left, first, leftCount, depth + 1, leftBox, leftCenters);
+        uint32_t right = addNode(index);
+        tree.nodes[index].offset = right;
+        tree.nodes[index].count = 0;
+        build(right, first + leftCount, count - leftCount, depth + 1, rightBox, rightCenters);
+    }
+};
+
+Bvh::~Bvh() {
+    try {
+        waitForRebuild();
+    } catch (...) {
+        // A failed rebuild doesn't matter any more
+    }
+}
+
+void Bvh::build(std::vector<Aabb> bounds) {
+    try {
+        waitForRebuild();
+    } catch (...) {
+        // Superseded by this build
+    }
+    bounds_ = std::move(bounds);
+    buildTree(bounds_, tree_);
+    resetRefitState();
+}
+
+void Bvh::buildTree(const std::vector<Aabb>& bounds, Tree& tree) {
+    uint32_t count = static_cast<uint32_t>(bounds.size());
+    tree.nodes.clear();
+    tree.parents.clear();
+    tree.objects.resize(count);
+    tree.objectBounds.resize(count);
+    tree.objectSlots.resize(count);
+    tree.objectLeaves.resize(count);
+    tree.buildCost = 1.0;
+    if (count == 0) {
+        return;
+    }
+
+    // A binary tree with at least one object per leaf has fewer than 2 * count nodes
+    tree.nodes.reserve(2 * static_cast<size_t>(count));
+    tree.parents.reserve(2 * static_cast<size_t>(count));
+    Builder builder{std::vector<Builder::Reference>(count), tree};
+    for (uint32_t i = 0; i < count; i++) {
+        builder.references[i] = {bounds[i], bounds[i].center(), i};
+    }
+    Aabb box, centerBox;
+    builder.computeBounds(0, count, box, centerBox);
+    builder.build(builder.addNode(NO_PARENT), 0, count, 0, box, centerBox);
+
+    float rootArea = nodeBounds(tree.nodes[0]).surfaceArea();
+    double cost = computeCost(tree);
+    tree.buildCost = rootArea > 0.0f && cost > 0.0 ? cost / rootArea : 1.0;
+}
+
+double Bvh::computeCost(const Tree& tree) {
+    double cost = 0.0;
+    for (const Node& node : tree.nodes) {
+        cost += nodeBounds(node).surfaceArea() * (node.count > 0 ? static_cast<float>(node.count) : TRAVERSAL_COST);
+    }
+    return cost;
+}
+
+void Bvh::resetRefitState() {
+    dirtyNodes_.assign(tree_.nodes.size(), 0);
+    dirty_ = false;
+    cost_ = computeCost(tree_);
+}
+
+void Bvh::update(uint32_t object, const Aabb& bounds) {
+    bounds_[object] = bounds;
+    tree_.objectBounds[tree_.objectSlots[object]] = bounds;
+    dirtyNodes_[tree_.objectLeaves[object]] = 1;
+    dirty_ = true;
+}
+
+void Bvh::refit() {
+    if (!dirty_) {
+        return;
+    }
+    // Children always come after their parent, so a backwards sweep sees them first
+    for (size_t i = tree_.nodes.size(); i-- > 0;) {
+        if (!dirtyNodes_[i]) {
+            continue;
+        }
+        dirtyNodes_[i] = 0;
+        Node& node = tree_.nodes[i];
+        Aabb box;
+        if (node.count > 0) {
+            for (uint32_t j = node.offset; j < node.offset + node.count; j++) {
+                box.grow(tree_.objectBounds[j]);
+            }
+        } else {
+            box = nodeBounds(tree_.nodes[i + 1]);
+            box.grow(nodeBounds(tree_.nodes[node.offset]));
+        }
+        if (box.min == node.min && box.max == node.max) {
+            continue; // Nothing above changes either
+        }
+
+        float weight = node.count > 0 ? static_cast<float>(node.count) : TRAVERSAL_COST;
+        cost_ += (static_cast<double>(box.surfaceArea()) - nodeBounds(node).surfaceArea()) * weight;
+        node.min = box.min;
+        node.max = box.max;
+        if (tree_.parents[i] != NO_PARENT) {
+            dirtyNodes_[tree_.parents[i]] = 1;
+        }
+    }
+    dirty_ = false;
+}
+
+float Bvh::getCostRatio() const {
+    if (tree_.nodes.empty()) {
+        return 1.0f;
+    }
+    float rootArea = nodeBounds(tree_.nodes[0]).surfaceArea();
+    if (rootArea <= 0.0f) {
+        return 1.0f;
+    }
+    return static_cast<float>(cost_ / rootArea / tree_.buildCost);
+}
+
+void Bvh::rebuildAsync(JobSystem& jobSystem) {
+    if (pending_) {
+        return;
+    }
+    pending_ = std::make_unique<PendingRebuild>();
+    pending_->bounds = bounds_;
+    pending_->jobSystem = &jobSystem;
+    PendingRebuild* rebuild = pending_.get();
+    jobSystem.run([rebuild] { buildTree(rebuild->bounds, rebuild->tree); }, &rebuild->done);
+}
+
+bool Bvh::finishRebuild() {
+    if (!pending_ || !pending_->done.isDone()) {
+        return false;
+    }
+    std::unique_ptr<PendingRebuild> rebuild = std::move(pending_);
+    rebuild->jobSystem->wait(rebuild->done); // Rethrows if the build failed
+    tree_ = std::move(rebuild->tree);
+
+    // The new tree has the snapshot's boxes, refit every node to the current bounds
+    for (size_t i = 0; i < tree_.objects.size(); i++) {
+        tree_.objectBounds[i] = bounds_[tree_.objects[i]];
+    }
+    resetRefitState();
+    std::fill(dirtyNodes_.begin(), dirtyNodes_.end(), 1);
+    dirty_ = !dirtyNodes_.empty();
+    refit();
+    return true;
+}
+
+void Bvh::waitForRebuild() {
+    if (pending_) {
+        std::unique_ptr<PendingRebuild> rebuild = std::move(pending_);
+        rebuild->jobSystem->wait(rebuild->done);
+    }
+}
+
+void Bvh::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+    if (tree_.nodes.empty()) {
+        return;
+    }
+    // Planes a node is entirely inside of are dropped for its whole subtree
+    struct Entry {
+        uint32_t node;
+        uint32_t planeMask;
+    };
+    Entry stack[MAX_DEPTH + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0x3F};
+    while (stackSize > 0) {
+        Entry entry = stack[--stackSize];
+        const Node& node = tree_.nodes[entry.node];
+        if (!classifyBox(frustum, node.min, node.max, entry.planeMask)) {
+            continue;
+        }
+
+        if (entry.planeMask == 0) {
+            // Inside all planes: the subtree's objects are one contiguous range, from its
+            // leftmost leaf to its rightmost one
+            uint32_t first = entry.node;
+            while (tree_.nodes[first].count == 0) {
+                first++;
+            }
+            uint32_t last = entry.node;
+            while (tree_.nodes[last].count == 0) {
+                last = tree_.nodes[last].offset;
+            }
+            visible.insert(visible.end(), tree_.objects.begin() + tree_.nodes[first].offset,
+                           tree_.objects.begin() + tree_.nodes[last].offset + tree_.nodes[last].count);
+        } else if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                uint32_t planeMask = entry.planeMask;
+                if (classifyBox(frustum, tree_.objectBounds[i].min, tree_.objectBounds[i].max, planeMask)) {
+                    visible.push_back(tree_.objects[i]);
+                }
+            }
+        } else {
+            stack[stackSize++] = {node.offset, entry.planeMask};
+            stack[stackSize++] = {entry.node + 1, entry.planeMask};
+        }
+    }
+}
+
+void Bvh::queryAabb(const Aabb& bounds, std::vector<uint32_t>& result) const {
+    if (tree_.nodes.empty()) {
+        return;
+    }
+    uint32_t stack[MAX_DEPTH + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t index = stack[--stackSize];
+        const Node& node = tree_.nodes[index];
+        if (!nodeBounds(node).overlaps(bounds)) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                if (tree_.objectBounds[i].overlaps(bounds)) {
+                    result.push_back(tree_.objects[i]);
+                }
+            }
+        } else {
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = index + 1;
+        }
+    }
+}
+
+Bvh::RayHit Bvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+    RayHit hit;
+    if (tree_.nodes.empty()) {
+        return hit;
+    }
+    // Zero components would turn into 0 * inf = NaN in the slab test
+    glm::vec3 inverseDirection;
+    for (int axis = 0; axis < 3; axis++) {
+        float d = direction[axis];
+        inverseDirection[axis] = 1.0f / (std::abs(d) > 1e-30f ? d : 1e-30f);
+    }
+
+    float closest = maxDistance;
+    if (intersectRay(tree_.nodes[0].min, tree_.nodes[0].max, origin, inverseDirection, closest) == FLT_MAX) {
+        return hit;
+    }
+    // Entry distances are kept with the nodes, the closest hit may have moved past them since
+    struct Entry {
+        uint32_t node;
+        float distance;
+    };
+    Entry stack[MAX_DEPTH + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0.0f};
+    while (stackSize > 0) {
+        Entry entry = stack[--stackSize];
+        if (entry.distance > closest) {
+            continue;
+        }
+        const Node& node = tree_.nodes[entry.node];
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                float t = intersectRay(tree_.objectBounds[i].min, tree_.objectBounds[i].max, origin, inverseDirection, closest);
+                if (t < closest || (t == closest && hit.object == INVALID_OBJECT)) {
+                    closest = t;
+                    hit.object = tree_.objects[i];
+                    hit.distance = t;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child on top of the stack; children the ray enters past the closest hit are skipped
+        uint32_t near = entry.node + 1;
+        uint32_t far = node.offset;
+        float tNear = intersectRay(tree_.nodes[near].min, tree_.nodes[near].max, origin, inverseDirection, closest);
+        float tFar = intersectRay(tree_.nodes[far].min, tree_.nodes[far].max, origin, inverseDirection, closest);
+        if (tFar < tNear) {
+            std::swap(near, far);
+            std::swap(tNear, tFar);
+        }
+        if (tFar != FLT_MAX) {
+            stack[stackSize++] = {far, tFar};
+        }
+        if (tNear != FLT_MAX) {
+            stack[stackSize++] = {near, tNear};
+        }
+    }
+    return hit;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,40 @@
+#include "VulkanEngine/DeletionQueue.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace VulkanEngine {
+
+DeletionQueue::~DeletionQueue() {
+    if (!entries_.empty()) {
+        // Leaking is safer than destroying something the GPU may still use
+        std::cerr << "[WARN] DeletionQueue destroyed with " << entries_.size() << " pending deletions" << std::endl;
+    }
+}
+
+void DeletionQueue::enqueue(uint64_t retireValue, std::function<void()> deleter) {
+    if (!entries_.empty() && retireValue < entries_.back().retireValue) {
+        throw std::runtime_error("DeletionQueue: retire values must not decrease");
+    }
+    entries_.push_back({retireValue, std::move(deleter)});
+}
+
+void DeletionQueue::collect(uint64_t completedValue) {
+    while (!entries_.empty() && entries_.front().retireValue <= completedValue) {
+        // Pop before running so a deleter may enqueue further work
+        std::function<void()> deleter = std::move(entries_.front().deleter);
+        entries_.pop_front();
+        deleter();
+    }
+}
+
+void DeletionQueue::flush() {
+    while (!entries_.empty()) {
+        std::function<void()> deleter = std::move(entries_.front().deleter);
+        entries_.pop_front();
+        deleter();
+    }
+}
+
+} // namespace VulkanEngine
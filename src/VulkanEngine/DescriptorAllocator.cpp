@@ -0,0 +1,89 @@
+#include "VulkanEngine/DescriptorAllocator.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+DescriptorAllocator::DescriptorAllocator(VulkanDevice& device, uint32_t frameCount, std::vector<PoolRatio> ratios,
+                                         uint32_t initialSetsPerPool)
+    : device_(device.getDevice()), ratios_(std::move(ratios)),
+      nextSetsPerPool_(std::clamp(initialSetsPerPool, 1u, MAX_SETS_PER_POOL)), frames_(frameCount)
+{
+    if (frameCount == 0 || ratios_.empty()) {
+        throw std::runtime_error("DescriptorAllocator: need at least one frame and one descriptor type");
+    }
+    // Every frame starts with one pool, so a typical frame never creates any
+    for (Frame& frame : frames_) {
+        frame.pools.push_back(createPool(nextSetsPerPool_));
+    }
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+    for (Frame& frame : frames_) {
+        for (vk::DescriptorPool pool : frame.pools) {
+            device_.destroyDescriptorPool(pool);
+        }
+    }
+}
+
+vk::DescriptorPool DescriptorAllocator::createPool(uint32_t setCount) {
+    std::vector<vk::DescriptorPoolSize> poolSizes;
+    for (const PoolRatio& ratio : ratios_) {
+        uint32_t count = static_cast<uint32_t>(std::ceil(ratio.descriptorsPerSet * setCount));
+        poolSizes.push_back(vk::DescriptorPoolSize(ratio.type, std::max(count, 1u)));
+    }
+    return device_.createDescriptorPool(vk::DescriptorPoolCreateInfo({}, setCount, poolSizes));
+}
+
+void DescriptorAllocator::beginFrame(uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frameIndex_ = frameIndex;
+    Frame& frame = frames_[frameIndex_];
+    // Only pools that were used need a reset
+    for (size_t i = 0; i <= frame.current && i < frame.pools.size(); i++) {
+        device_.resetDescriptorPool(frame.pools[i]);
+    }
+    frame.current = 0;
+}
+
+vk::DescriptorSet DescriptorAllocator::allocate(vk::DescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Frame& frame = frames_[frameIndex_];
+    vk::DescriptorSetAllocateInfo allocInfo(nullptr, layout);
+    while (true) {
+        bool freshPool = frame.current == frame.pools.size();
+        if (freshPool) {
+            frame.pools.push_back(createPool(nextSetsPerPool_));
+            std::cout << "Descriptor pool " << frame.pools.size() << " of frame " << frameIndex_ << " created ("
+                      << nextSetsPerPool_ << " sets)" << std::endl;
+            nextSetsPerPool_ = std::min(nextSetsPerPool_ + nextSetsPerPool_ / 2, MAX_SETS_PER_POOL);
+        }
+        allocInfo.descriptorPool = frame.pools[frame.current];
+        try {
+            return device_.allocateDescriptorSets(allocInfo).front();
+        } catch (const vk::OutOfPoolMemoryError&) {
+        } catch (const vk::FragmentedPoolError&) {
+        }
+        if (freshPool) {
+            // Growing won't help, the set needs descriptor types or counts the ratios don't provide
+            throw std::runtime_error("DescriptorAllocator: layout doesn't fit an empty pool");
+        }
+        // Full for this frame, the next pool (or a new one) takes over
+        frame.current++;
+    }
+}
+
+size_t DescriptorAllocator::getPoolCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const Frame& frame : frames_) {
+        count += frame.pools.size();
+    }
+    return count;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,148 @@
+#include "VulkanEngine/DescriptorLayoutCache.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+DescriptorData DescriptorData::fromBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+    DescriptorData data;
+    data.buffer = VkDescriptorBufferInfo{static_cast<VkBuffer>(buffer), offset, range};
+    return data;
+}
+
+DescriptorData DescriptorData::fromImage(vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout) {
+    DescriptorData data;
+    data.image = VkDescriptorImageInfo{static_cast<VkSampler>(sampler), static_cast<VkImageView>(view),
+                                      static_cast<VkImageLayout>(layout)};
+    return data;
+}
+
+DescriptorLayoutCache::DescriptorLayoutCache(VulkanDevice& device) : device_(device.getDevice()) {}
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+    for (LayoutInfo& info : layouts_) {
+        if (info.updateTemplate) {
+            device_.destroyDescriptorUpdateTemplate(info.updateTemplate);
+        }
+        device_.destroyDescriptorSetLayout(info.layout);
+    }
+}
+
+size_t DescriptorLayoutCache::hashBindings(const std::vector<vk::DescriptorSetLayoutBinding>& bindings) {
+    // FNV-1a, same as PipelineKeyHash
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    for (const vk::DescriptorSetLayoutBinding& binding : bindings) {
+        mix(binding.binding);
+        mix(static_cast<uint64_t>(binding.descriptorType));
+        mix(binding.descriptorCount);
+        mix(static_cast<uint64_t>(static_cast<VkShaderStageFlags>(binding.stageFlags)));
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool DescriptorLayoutCache::equalBindings(const std::vector<vk::DescriptorSetLayoutBinding>& a,
+                                          const std::vector<vk::DescriptorSetLayoutBinding>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].binding != b[i].binding || a[i].descriptorType != b[i].descriptorType ||
+            a[i].descriptorCount != b[i].descriptorCount || a[i].stageFlags != b[i].stageFlags) {
+            return false;
+        }
+        bool hasSamplers = a[i].pImmutableSamplers != nullptr;
+        if (hasSamplers != (b[i].pImmutableSamplers != nullptr) ||
+            (hasSamplers && !std::equal(a[i].pImmutableSamplers, a[i].pImmutableSamplers + a[i].descriptorCount,
+                                        b[i].pImmutableSamplers))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+vk::DescriptorSetLayout DescriptorLayoutCache::get(std::vector<vk::DescriptorSetLayoutBinding> bindings) {
+    std::sort(bindings.begin(), bindings.end(), [](const vk::DescriptorSetLayoutBinding& a, const vk::DescriptorSetLayoutBinding& b) {
+        return a.binding < b.binding;
+    });
+    size_t hash = hashBindings(bindings);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = byHash_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (equalBindings(layouts_[it->second].bindings, bindings)) {
+            return layouts_[it->second].layout;
+        }
+    }
+
+    LayoutInfo info;
+    info.layout = device_.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, bindings));
+    info.bindings = std::move(bindings);
+    // The caller's immutable sampler arrays may not outlive this call, keep a copy for comparisons
+    for (vk::DescriptorSetLayoutBinding& binding : info.bindings) {
+        if (binding.pImmutableSamplers) {
+            info.immutableSamplers.emplace_back(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+            binding.pImmutableSamplers = info.immutableSamplers.back().data();
+        }
+    }
+    layouts_.push_back(std::move(info));
+    byHash_.emplace(hash, layouts_.size() - 1);
+    return layouts_.back().layout;
+}
+
+DescriptorLayoutCache::LayoutInfo& DescriptorLayoutCache::findInfo(vk::DescriptorSetLayout layout) {
+    for (LayoutInfo& info : layouts_) {
+        if (info.layout == layout) {
+            return info;
+        }
+    }
+    throw std::runtime_error("DescriptorLayoutCache: layout was not created by this cache");
+}
+
+vk::DescriptorUpdateTemplate DescriptorLayoutCache::getUpdateTemplate(vk::DescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LayoutInfo& info = findInfo(layout);
+    if (info.updateTemplate) {
+        return info.updateTemplate;
+    }
+
+    // One entry per binding, reading its descriptors back to back from the DescriptorData array
+    std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+    size_t offset = 0;
+    for (const vk::DescriptorSetLayoutBinding& binding : info.bindings) {
+        if (binding.descriptorCount == 0) {
+            continue;
+        }
+        entries.emplace_back(binding.binding, 0, binding.descriptorCount, binding.descriptorType,
+                             offset * sizeof(DescriptorData), sizeof(DescriptorData));
+        offset += binding.descriptorCount;
+    }
+    vk::DescriptorUpdateTemplateCreateInfo createInfo({}, entries, vk::DescriptorUpdateTemplateType::eDescriptorSet, layout);
+    info.updateTemplate = device_.createDescriptorUpdateTemplate(createInfo);
+    return info.updateTemplate;
+}
+
+uint32_t DescriptorLayoutCache::getDescriptorCount(vk::DescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t count = 0;
+    for (const vk::DescriptorSetLayoutBinding& binding : findInfo(layout).bindings) {
+        count += binding.descriptorCount;
+    }
+    return count;
+}
+
+void DescriptorLayoutCache::update(vk::DescriptorSet set, vk::DescriptorSetLayout layout, const DescriptorData* data) {
+    device_.updateDescriptorSetWithTemplate(set, getUpdateTemplate(layout), data);
+}
+
+size_t DescriptorLayoutCache::getLayoutCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return layouts_.size();
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,65 @@
+#include "VulkanEngine/FrameAllocator.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace VulkanEngine {
+
+static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+FrameAllocator::FrameAllocator(VulkanDevice& device, MemoryAllocator& allocator, vk::DeviceSize bytesPerFrame, uint32_t frameCount,
+                               vk::BufferUsageFlags usage)
+    : device_(device.getDevice()), allocator_(allocator), frameCount_(frameCount)
+{
+    const vk::PhysicalDeviceLimits& limits = device.getPhysicalDevice().getProperties().limits;
+    alignment_ = 1;
+    if (usage & vk::BufferUsageFlagBits::eUniformBuffer) {
+        alignment_ = std::max(alignment_, limits.minUniformBufferOffsetAlignment);
+    }
+    if (usage & vk::BufferUsageFlagBits::eStorageBuffer) {
+        alignment_ = std::max(alignment_, limits.minStorageBufferOffsetAlignment);
+    }
+
+    bytesPerFrame_ = alignUp(bytesPerFrame, alignment_);
+    vk::DeviceSize totalSize = bytesPerFrame_ * frameCount_;
+    // Dynamic offsets are 32-bit
+    if (totalSize > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("FrameAllocator: buffer too large for 32-bit dynamic offsets");
+    }
+
+    vk::BufferCreateInfo bufferInfo({}, totalSize, usage, vk::SharingMode::eExclusive);
+    buffer_ = device_.createBuffer(bufferInfo);
+    allocation_ = allocator_.allocateBuffer(buffer_,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+FrameAllocator::~FrameAllocator() {
+    device_.destroyBuffer(buffer_);
+    allocator_.free(allocation_);
+}
+
+void FrameAllocator::beginFrame(uint32_t frameIndex) {
+    frameBase_ = bytesPerFrame_ * (frameIndex % frameCount_);
+    head_ = frameBase_;
+}
+
+FrameAllocator::Slice FrameAllocator::allocate(vk::DeviceSize size) {
+    vk::DeviceSize alignedSize = alignUp(size, alignment_);
+    if (head_ + alignedSize > frameBase_ + bytesPerFrame_) {
+        throw std::runtime_error("FrameAllocator: frame budget of " + std::to_string(bytesPerFrame_) + " bytes exhausted");
+    }
+
+    Slice slice;
+    slice.data = static_cast<char*>(allocation_.mappedData) + head_;
+    slice.offset = static_cast<uint32_t>(head_);
+    slice.size = size;
+    head_ += alignedSize;
+    return slice;
+}
+
+} // namespace VulkanEngine
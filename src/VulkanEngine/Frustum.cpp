@@ -0,0 +1,30 @@
+#include "VulkanEngine/Frustum.h"
+
+namespace VulkanEngine {
+
+Frustum Frustum::fromViewProjection(const glm::mat4& viewProjection) {
+    // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&viewProjection](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+    Frustum frustum;
+    frustum.planes = {w + x, w - x, w + y, w - y, w + z, w - z};
+    // Normalized so w is a true distance, sphere tests compare it against the radius
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,184 @@
+#include "VulkanEngine/FrustumCuller.h"
+#include "VulkanEngine/FrustumCullerKernels.h"
+#include "VulkanEngine/JobSystem.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VULKAN_ENGINE_X86 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <immintrin.h> // _xgetbv
+#include <intrin.h>
+#endif
+#endif
+
+namespace VulkanEngine {
+
+// --- BoundingSpheres ---
+
+void BoundingSpheres::resize(uint32_t count) {
+    count_ = count;
+    size_t padded = (static_cast<size_t>(count) + 7) & ~size_t(7);
+    centerX_.assign(padded, 0.0f);
+    centerY_.assign(padded, 0.0f);
+    centerZ_.assign(padded, 0.0f);
+    // Padding spheres have a hugely negative radius, every plane rejects them
+    radius_.assign(padded, -FLT_MAX);
+}
+
+void BoundingSpheres::set(uint32_t index, const glm::vec3& center, float radius) {
+    centerX_[index] = center.x;
+    centerY_[index] = center.y;
+    centerZ_[index] = center.z;
+    radius_[index] = radius;
+}
+
+// --- Kernels ---
+
+namespace CullKernels {
+
+uint32_t scalar(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out) {
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        bool visible = true;
+        for (int p = 0; p < 6; p++) {
+            const float* plane = planes + p * 4;
+            // Same operation order as the SIMD kernels, so results match exactly
+            float distance = plane[0] * spheres.x[i] + plane[1] * spheres.y[i] + plane[2] * spheres.z[i] + plane[3];
+            if (distance < -spheres.radius[i]) {
+                visible = false;
+                break;
+            }
+        }
+        if (visible) {
+            out[count++] = i;
+        }
+    }
+    return count;
+}
+
+#ifdef VULKAN_ENGINE_X86
+// SSE2 is part of x86-64, no runtime check needed
+static __m128 outsideMask4(const float* planes, const SphereArrays& spheres, uint32_t base) {
+    __m128 x = _mm_loadu_ps(spheres.x + base);
+    __m128 y = _mm_loadu_ps(spheres.y + base);
+    __m128 z = _mm_loadu_ps(spheres.z + base);
+    __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + base));
+    __m128 outside = _mm_setzero_ps();
+    for (int p = 0; p < 6; p++) {
+        const float* plane = planes + p * 4;
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(plane[0]), x), _mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+            _mm_mul_ps(_mm_set1_ps(plane[2]), z)), _mm_set1_ps(plane[3]));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+    }
+    return outside;
+}
+
+uint32_t sse(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out) {
+    uint32_t count = 0;
+    for (uint32_t base = begin & ~7u; base < end; base += 8) {
+        // Two halves of 8, like one AVX2 iteration
+        uint32_t outside = static_cast<uint32_t>(_mm_movemask_ps(outsideMask4(planes, spheres, base))) |
+                           static_cast<uint32_t>(_mm_movemask_ps(outsideMask4(planes, spheres, base + 4))) << 4;
+        count += emitVisible(~outside & rangeMask(base, begin, end), base, out + count);
+    }
+    return count;
+}
+#endif
+
+} // namespace CullKernels
+
+// --- FrustumCuller ---
+
+FrustumCuller::Isa FrustumCuller::getBestIsa() {
+#ifdef VULKAN_ENGINE_X86
+    if (CullKernels::avx2Compiled()) {
+#if defined(__GNUC__) || defined(__clang__)
+        // Also checks that the OS saves the YMM registers
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return Isa::eAVX2;
+        }
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            if (osSavesYmm && (info[1] & (1 << 5))) {
+                return Isa::eAVX2;
+            }
+        }
+#endif
+    }
+    return Isa::eSSE;
+#else
+    return Isa::eScalar;
+#endif
+}
+
+const char* FrustumCuller::getIsaName(Isa isa) {
+    switch (isa) {
+        case Isa::eAVX2: return "AVX2";
+        case Isa::eSSE: return "SSE";
+        default: return "scalar";
+    }
+}
+
+FrustumCuller::FrustumCuller() : isa_(getBestIsa()) {}
+
+FrustumCuller::FrustumCuller(Isa isa) : isa_(std::min(isa, getBestIsa())) {}
+
+uint32_t FrustumCuller::cullRange(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t begin, uint32_t end,
+                                  uint32_t* out) const {
+    const float* planes = &frustum.planes[0].x;
+    CullKernels::SphereArrays arrays{spheres.centerX(), spheres.centerY(), spheres.centerZ(), spheres.radius()};
+    switch (isa_) {
+#ifdef VULKAN_ENGINE_X86
+        case Isa::eAVX2: return CullKernels::avx2(planes, arrays, begin, end, out);
+        case Isa::eSSE: return CullKernels::sse(planes, arrays, begin, end, out);
+#endif
+        default: return CullKernels::scalar(planes, arrays, begin, end, out);
+    }
+}
+
+void FrustumCuller::cull(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t begin, uint32_t end,
+                         std::vector<uint32_t>& visible) const {
+    end = std::min(end, spheres.size());
+    if (begin >= end) {
+        return;
+    }
+    size_t offset = visible.size();
+    visible.resize(offset + (end - begin));
+    visible.resize(offset + cullRange(frustum, spheres, begin, end, visible.data() + offset));
+}
+
+void FrustumCuller::cullParallel(JobSystem& jobSystem, const Frustum& frustum, const BoundingSpheres& spheres,
+                                 std::vector<uint32_t>& visible) const {
+    // Every chunk writes to its own slice of visible, then the slices are packed in order
+    uint32_t count = spheres.size();
+    uint32_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    visible.resize(count);
+    std::vector<uint32_t> chunkVisible(chunkCount);
+    jobSystem.parallelFor(chunkCount, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; chunk++) {
+            uint32_t begin = chunk * CHUNK_SIZE;
+            uint32_t end = std::min(begin + CHUNK_SIZE, count);
+            chunkVisible[chunk] = cullRange(frustum, spheres, begin, end, visible.data() + begin);
+        }
+    });
+
+    uint32_t total = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+        std::memmove(visible.data() + total, visible.data() + chunk * CHUNK_SIZE, chunkVisible[chunk] * sizeof(uint32_t));
+        total += chunkVisible[chunk];
+    }
+    visible.resize(total);
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,57 @@
+// Built with AVX2 enabled (see CMakeLists.txt). Only called after FrustumCuller has
+// checked the CPU, so nothing else may live in this file.
+#include "VulkanEngine/FrustumCullerKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace VulkanEngine {
+namespace CullKernels {
+
+#if defined(__AVX2__)
+
+bool avx2Compiled() {
+    return true;
+}
+
+uint32_t avx2(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out) {
+    __m256 planeComponents[24];
+    for (int i = 0; i < 24; i++) {
+        planeComponents[i] = _mm256_set1_ps(planes[i]);
+    }
+
+    uint32_t count = 0;
+    for (uint32_t base = begin & ~7u; base < end; base += 8) {
+        __m256 x = _mm256_loadu_ps(spheres.x + base);
+        __m256 y = _mm256_loadu_ps(spheres.y + base);
+        __m256 z = _mm256_loadu_ps(spheres.z + base);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + base));
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            // No FMA: the scalar and SSE kernels round after every multiply, results have to match
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(planeComponents[p * 4 + 0], x), _mm256_mul_ps(planeComponents[p * 4 + 1], y)),
+                _mm256_mul_ps(planeComponents[p * 4 + 2], z)), planeComponents[p * 4 + 3]);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+        }
+        uint32_t outsideBits = static_cast<uint32_t>(_mm256_movemask_ps(outside));
+        count += emitVisible(~outsideBits & rangeMask(base, begin, end), base, out + count);
+    }
+    return count;
+}
+
+#else
+
+bool avx2Compiled() {
+    return false;
+}
+
+uint32_t avx2(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out) {
+    return scalar(planes, spheres, begin, end, out);
+}
+
+#endif
+
+} // namespace CullKernels
+} // namespace VulkanEngine
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+// Culling kernels behind FrustumCuller. Internal: the AVX2 kernel lives in its own
+// translation unit built with AVX2 enabled, so this header must stay free of anything
+// with external linkage that could get compiled with AVX2 instructions (glm, std
+// containers). Helpers are static for the same reason.
+namespace VulkanEngine {
+namespace CullKernels {
+
+struct SphereArrays {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* radius;
+};
+
+// All kernels take the frustum as 6 planes of 4 floats (see Frustum), write the indices
+// of visible spheres in [begin, end) to out in ascending order and return their count.
+// Arrays must be padded to a multiple of 8.
+uint32_t scalar(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out);
+uint32_t sse(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out);
+uint32_t avx2(const float* planes, const SphereArrays& spheres, uint32_t begin, uint32_t end, uint32_t* out);
+// False if the compiler couldn't build the AVX2 kernel
+bool avx2Compiled();
+
+// Bit i set if base + i is in [begin, end), for the 8 spheres starting at base
+static inline uint32_t rangeMask(uint32_t base, uint32_t begin, uint32_t end) {
+    uint32_t mask = 0xFF;
+    if (base < begin) {
+        mask &= 0xFFu << (begin - base);
+    }
+    if (end - base < 8) {
+        mask &= (1u << (end - base)) - 1;
+    }
+    return mask & 0xFF;
+}
+
+// Writes base + i for every set bit i of mask, returns how many
+static inline uint32_t emitVisible(uint32_t mask, uint32_t base, uint32_t* out) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; mask != 0; i++, mask >>= 1) {
+        if (mask & 1) {
+            out[count++] = base + i;
+        }
+    }
+    return count;
+}
+
+} // namespace CullKernels
+} // namespace VulkanEngine
@@ -0,0 +1,229 @@
+#include "VulkanEngine/JobSystem.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace VulkanEngine {
+
+thread_local uint32_t JobSystem::threadIndex_ = 0;
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0) {
+        // At least one worker, even on a single core or when the count is unknown: the
+        // creating thread runs its own newest job first, so without a worker a job nobody
+        // waits on could sit at the bottom of its deque forever
+        workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    queues_.resize(workerCount + 1);
+    for (auto& queue : queues_) {
+        queue = std::make_unique<WorkQueue>();
+    }
+
+    threadIndex_ = 0;
+    for (uint32_t i = 1; i <= workerCount; i++) {
+        workers_.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void JobSystem::run(Job job, Counter* counter) {
+    if (counter) {
+        counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    push({std::move(job), counter});
+}
+
+void JobSystem::runBackground(Job job, Counter* counter) {
+    if (counter) {
+        counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pushBackground({std::move(job), counter});
+}
+
+void JobSystem::runAfter(Counter& dependency, Job job, Counter* counter) {
+    if (counter) {
+        counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        // finish() drops the count and takes the continuations under the same lock
+        std::lock_guard<std::mutex> lock(dependency.mutex_);
+        if (dependency.pending_.load(std::memory_order_acquire) != 0) {
+            dependency.continuations_.emplace_back(std::move(job), counter);
+            return;
+        }
+    }
+    push({std::move(job), counter});
+}
+
+void JobSystem::wait(Counter& counter) {
+    while (!counter.isDone()) {
+        if (!tryRunOne(false)) {
+            std::this_thread::yield();
+        }
+    }
+    // finish() may still be inside the counter's lock; take it once so the caller can destroy the counter
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+    if (counter.error_) {
+        std::exception_ptr error = counter.error_;
+        counter.error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t minBatchSize, const std::function<void(uint32_t begin, uint32_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // A few batches per thread so stealing can even out uneven work
+    uint32_t maxBatches = getThreadCount() * 4;
+    uint32_t batchCount = std::max(1u, std::min(maxBatches, count / std::max(1u, minBatchSize)));
+    if (batchCount == 1) {
+        body(0, count);
+        return;
+    }
+
+    auto batchBegin = [count, batchCount](uint32_t batch) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(count) * batch / batchCount);
+    };
+
+    Counter counter;
+    for (uint32_t batch = 1; batch < batchCount; batch++) {
+        run([&body, &batchBegin, batch] { body(batchBegin(batch), batchBegin(batch + 1)); }, &counter);
+    }
+    std::exception_ptr error;
+    try {
+        body(0, batchBegin(1));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    wait(counter); // The other batches reference body, wait for them even on error
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::push(Task task) {
+    WorkQueue& queue = *queues_[threadIndex_];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queuedTasks_.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this against a worker that is about to sleep
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+}
+
+void JobSystem::pushBackground(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(backgroundQueue_.mutex);
+        backgroundQueue_.tasks.push_back(std::move(task));
+    }
+    queuedTasks_.fetch_add(1, std::memory_order_release);
+
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+}
+
+bool JobSystem::tryRunOne(bool includeBackground) {
+    uint32_t self = threadIndex_;
+    uint32_t threadCount = getThreadCount();
+    Task task;
+    bool found = false;
+
+    // Own work newest first (cache-warm), others' oldest first (biggest chunks)
+    for (uint32_t i = 0; i < threadCount && !found; i++) {
+        WorkQueue& queue = *queues_[(self + i) % threadCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        found = true;
+    }
+    if (!found && includeBackground) {
+        std::lock_guard<std::mutex> lock(backgroundQueue_.mutex);
+        if (!backgroundQueue_.tasks.empty()) {
+            task = std::move(backgroundQueue_.tasks.front());
+            backgroundQueue_.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    queuedTasks_.fetch_sub(1, std::memory_order_relaxed);
+
+    std::exception_ptr error;
+    try {
+        task.job();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    finish(task.counter, error);
+    return true;
+}
+
+void JobSystem::finish(Counter* counter, std::exception_ptr error) {
+    if (!counter) {
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                std::cerr << "[WARN] Job without counter threw: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "[WARN] Job without counter threw" << std::endl;
+            }
+        }
+        return;
+    }
+
+    std::vector<std::pair<Job, Counter*>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex_);
+        if (error && !counter->error_) {
+            counter->error_ = error;
+        }
+        if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuations.swap(counter->continuations_);
+        }
+    }
+    // counter may be gone from here on
+    for (auto& [job, continuationCounter] : continuations) {
+        push({std::move(job), continuationCounter});
+    }
+}
+
+void JobSystem::workerLoop(uint32_t threadIndex) {
+    threadIndex_ = threadIndex;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (tryRunOne(true)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stopping_.load(std::memory_order_acquire) || queuedTasks_.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+} // namespace VulkanEngine
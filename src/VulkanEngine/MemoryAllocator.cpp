@@ -0,0 +1,317 @@
+#include "VulkanEngine/MemoryAllocator.h"
+#include "VulkanEngine/VulkanDevice.h"
+#include "VulkanEngine/MemoryBudget.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+
+namespace VulkanEngine {
+
+// One VkDeviceMemory carved up by a TLSF allocator
+struct MemoryBlock {
+    explicit MemoryBlock(vk::DeviceSize size) : tlsf(size) {}
+
+    vk::DeviceMemory memory = nullptr;
+    TlsfAllocator tlsf;
+    void* mappedData = nullptr;
+    uint32_t memoryTypeIndex = 0;
+    uint32_t poolKey = 0;
+};
+
+// Heaps up to this size get blocks of 1/8 of the heap, bigger ones get LARGE_HEAP_BLOCK_SIZE
+static constexpr vk::DeviceSize SMALL_HEAP_MAX_SIZE = 1024ull * 1024 * 1024;
+static constexpr vk::DeviceSize LARGE_HEAP_BLOCK_SIZE = 256ull * 1024 * 1024;
+
+MemoryAllocator::MemoryAllocator(VulkanDevice& device)
+    : vulkanDevice_(device), device_(device.getDevice())
+{
+    vk::PhysicalDevice physicalDevice = vulkanDevice_.getPhysicalDevice();
+    vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+    memoryProperties_ = physicalDevice.getMemoryProperties();
+
+    bufferImageGranularity_ = properties.limits.bufferImageGranularity;
+    maxMemoryAllocationCount_ = properties.limits.maxMemoryAllocationCount;
+    dedicatedAllocationQueries_ = properties.apiVersion >= VK_API_VERSION_1_1;
+
+    heapStats_.resize(memoryProperties_.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties_.memoryHeapCount; i++) {
+        heapStats_[i].heapSize = memoryProperties_.memoryHeaps[i].size;
+    }
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    for (size_t i = 0; i < heapStats_.size(); i++) {
+        if (heapStats_[i].allocationCount > 0) {
+            std::cerr << "[WARN] MemoryAllocator destroyed with " << heapStats_[i].allocationCount
+                      << " live allocations in heap " << i << std::endl;
+        }
+    }
+    for (auto& [key, pool] : pools_) {
+        for (auto& block : pool) {
+            device_.freeMemory(block->memory);
+        }
+    }
+}
+
+Allocation MemoryAllocator::allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties) {
+    vk::MemoryRequirements requirements;
+    bool dedicated = false;
+    if (dedicatedAllocationQueries_) {
+        auto chain = device_.getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+            vk::BufferMemoryRequirementsInfo2(buffer));
+        requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+        dedicated = chain.get<vk::MemoryDedicatedRequirements>().requiresDedicatedAllocation;
+    } else {
+        requirements = device_.getBufferMemoryRequirements(buffer);
+    }
+
+    Allocation allocation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocation = allocateLocked(requirements, properties, ResourceKind::eBuffer, dedicated, buffer, nullptr);
+    }
+    device_.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+    return allocation;
+}
+
+Allocation MemoryAllocator::allocateImage(vk::Image image, vk::MemoryPropertyFlags properties) {
+    vk::MemoryRequirements requirements;
+    bool dedicated = false;
+    if (dedicatedAllocationQueries_) {
+        auto chain = device_.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+            vk::ImageMemoryRequirementsInfo2(image));
+        requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+        const auto& dedicatedRequirements = chain.get<vk::MemoryDedicatedRequirements>();
+        // Render targets usually prefer their own allocation (compression metadata etc.)
+        dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    } else {
+        requirements = device_.getImageMemoryRequirements(image);
+    }
+
+    Allocation allocation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocation = allocateLocked(requirements, properties, ResourceKind::eImage, dedicated, nullptr, image);
+    }
+    device_.bindImageMemory(image, allocation.memory, allocation.offset);
+    return allocation;
+}
+
+Allocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties,
+                                     ResourceKind kind, bool dedicated) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocateLocked(requirements, properties, kind, dedicated, nullptr, nullptr);
+}
+
+Allocation MemoryAllocator::allocateLocked(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties,
+                                           ResourceKind kind, bool dedicated, vk::Buffer buffer, vk::Image image) {
+    uint32_t memoryTypeIndex = chooseMemoryType(requirements, properties);
+
+    if (dedicated || requirements.size > preferredBlockSize(memoryTypeIndex) / DEDICATED_THRESHOLD_DIVISOR) {
+        return allocateDedicated(requirements, memoryTypeIndex, buffer, image);
+    }
+
+    uint32_t key = poolKey(memoryTypeIndex, kind);
+    auto& pool = pools_[key];
+
+    MemoryBlock* block = nullptr;
+    vk::DeviceSize offset = 0;
+    uint32_t node = TlsfAllocator::INVALID_NODE;
+    for (auto& candidate : pool) {
+        node = candidate->tlsf.allocate(requirements.size, requirements.alignment, offset);
+        if (node != TlsfAllocator::INVALID_NODE) {
+            block = candidate.get();
+            break;
+        }
+    }
+    if (!block) {
+        block = createBlock(memoryTypeIndex, key);
+        node = block->tlsf.allocate(requirements.size, requirements.alignment, offset);
+        if (node == TlsfAllocator::INVALID_NODE) {
+            throw std::runtime_error("Failed to sub-allocate from a fresh memory block!");
+        }
+    }
+
+    Allocation allocation;
+    allocation.memory = block->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mappedData = block->mappedData ? static_cast<char*>(block->mappedData) + offset : nullptr;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.block = block;
+    allocation.node = node;
+
+    HeapStats& stats = heapStats_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+    stats.allocationCount++;
+    stats.allocationBytes += allocation.size;
+    return allocation;
+}
+
+Allocation MemoryAllocator::allocateDedicated(const vk::MemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                                              vk::Buffer buffer, vk::Image image) {
+    checkAllocationCount();
+
+    vk::MemoryAllocateInfo allocInfo(requirements.size, memoryTypeIndex);
+    vk::MemoryDedicatedAllocateInfo dedicatedInfo(image, buffer);
+    if (dedicatedAllocationQueries_ && (buffer || image)) {
+        allocInfo.pNext = &dedicatedInfo;
+    }
+
+    Allocation allocation;
+    allocation.memory = device_.allocateMemory(allocInfo);
+    allocation.offset = 0;
+    allocation.size = requirements.size;
+    allocation.mappedData = mapIfHostVisible(allocation.memory, memoryTypeIndex, requirements.size);
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    deviceMemoryCount_++;
+
+    HeapStats& stats = heapStats_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+    stats.dedicatedCount++;
+    stats.allocationCount++;
+    stats.blockBytes += allocation.size;
+    stats.allocationBytes += allocation.size;
+    return allocation;
+}
+
+void MemoryAllocator::free(Allocation& allocation) {
+    if (!allocation) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    HeapStats& stats = heapStats_[memoryProperties_.memoryTypes[allocation.memoryTypeIndex].heapIndex];
+    stats.allocationCount--;
+    stats.allocationBytes -= allocation.size;
+
+    if (!allocation.block) {
+        // Freeing implicitly unmaps
+        device_.freeMemory(allocation.memory);
+        deviceMemoryCount_--;
+        stats.dedicatedCount--;
+        stats.blockBytes -= allocation.size;
+    } else {
+        MemoryBlock* block = allocation.block;
+        block->tlsf.free(allocation.node);
+
+        // Keep one empty block per pool around so churn doesn't hit vkAllocateMemory every time
+        if (block->tlsf.isEmpty()) {
+            auto& pool = pools_[block->poolKey];
+            size_t emptyBlocks = std::count_if(pool.begin(), pool.end(),
+                [](const std::unique_ptr<MemoryBlock>& b) { return b->tlsf.isEmpty(); });
+            if (emptyBlocks > 1) {
+                destroyBlock(block);
+            }
+        }
+    }
+
+    allocation = Allocation{};
+}
+
+MemoryBlock* MemoryAllocator::createBlock(uint32_t memoryTypeIndex, uint32_t key) {
+    checkAllocationCount();
+
+    vk::DeviceSize blockSize = preferredBlockSize(memoryTypeIndex);
+    auto block = std::make_unique<MemoryBlock>(blockSize);
+    block->memory = device_.allocateMemory(vk::MemoryAllocateInfo(blockSize, memoryTypeIndex));
+    block->mappedData = mapIfHostVisible(block->memory, memoryTypeIndex, blockSize);
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->poolKey = key;
+    deviceMemoryCount_++;
+
+    HeapStats& stats = heapStats_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+    stats.blockCount++;
+    stats.blockBytes += blockSize;
+
+    auto& pool = pools_[key];
+    pool.push_back(std::move(block));
+    return pool.back().get();
+}
+
+void MemoryAllocator::destroyBlock(MemoryBlock* block) {
+    HeapStats& stats = heapStats_[memoryProperties_.memoryTypes[block->memoryTypeIndex].heapIndex];
+    stats.blockCount--;
+    stats.blockBytes -= block->tlsf.getSize();
+
+    device_.freeMemory(block->memory);
+    deviceMemoryCount_--;
+
+    auto& pool = pools_[block->poolKey];
+    pool.erase(std::remove_if(pool.begin(), pool.end(),
+        [block](const std::unique_ptr<MemoryBlock>& b) { return b.get() == block; }), pool.end());
+}
+
+uint32_t MemoryAllocator::chooseMemoryType(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties) const {
+    // First matching type is what the driver lists as the best fit
+    uint32_t firstMatch = vulkanDevice_.findMemoryType(requirements.memoryTypeBits, properties);
+    if (!budget_) {
+        return firstMatch;
+    }
+
+    // Prefer a matching type whose heap still has room, before pushing a full heap into paging
+    for (uint32_t i = firstMatch; i < memoryProperties_.memoryTypeCount; i++) {
+        if (!(requirements.memoryTypeBits & (1u << i)) ||
+            (memoryProperties_.memoryTypes[i].propertyFlags & properties) != properties) {
+            continue;
+        }
+        uint32_t heapIndex = memoryProperties_.memoryTypes[i].heapIndex;
+        if (budget_->fits(heapIndex, requirements.size, heapStats_[heapIndex].blockBytes)) {
+            return i;
+        }
+    }
+    return firstMatch;
+}
+
+void MemoryAllocator::setBudget(const MemoryBudget* budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+}
+
+vk::DeviceSize MemoryAllocator::preferredBlockSize(uint32_t memoryTypeIndex) const {
+    vk::DeviceSize heapSize = memoryProperties_.memoryHeaps[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex].size;
+    return heapSize <= SMALL_HEAP_MAX_SIZE ? heapSize / 8 : LARGE_HEAP_BLOCK_SIZE;
+}
+
+uint32_t MemoryAllocator::poolKey(uint32_t memoryTypeIndex, ResourceKind kind) const {
+    // With a granularity of 1 buffers and images can share blocks freely
+    if (bufferImageGranularity_ <= 1) {
+        return memoryTypeIndex * 2;
+    }
+    return memoryTypeIndex * 2 + (kind == ResourceKind::eImage ? 1 : 0);
+}
+
+void* MemoryAllocator::mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryTypeIndex, vk::DeviceSize size) {
+    if (memoryProperties_.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+        return device_.mapMemory(memory, 0, size);
+    }
+    return nullptr;
+}
+
+void MemoryAllocator::checkAllocationCount() const {
+    if (deviceMemoryCount_ >= maxMemoryAllocationCount_) {
+        throw std::runtime_error("Exceeded maxMemoryAllocationCount (" + std::to_string(maxMemoryAllocationCount_) + ")!");
+    }
+}
+
+std::vector<HeapStats> MemoryAllocator::getHeapStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return heapStats_;
+}
+
+void MemoryAllocator::printStats(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    constexpr double MiB = 1024.0 * 1024.0;
+    for (size_t i = 0; i < heapStats_.size(); i++) {
+        const HeapStats& stats = heapStats_[i];
+        bool deviceLocal = static_cast<bool>(memoryProperties_.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        out << "Memory heap " << i << (deviceLocal ? " (device local)" : "") << ": "
+            << stats.allocationCount << " allocations in "
+            << stats.blockCount << " blocks + " << stats.dedicatedCount << " dedicated, "
+            << stats.allocationBytes / MiB << " / " << stats.blockBytes / MiB << " MiB used, heap "
+            << stats.heapSize / MiB << " MiB" << std::endl;
+    }
+    out << "Device memory objects: " << deviceMemoryCount_ << " / " << maxMemoryAllocationCount_ << std::endl;
+}
+
+} // namespace VulkanEngine
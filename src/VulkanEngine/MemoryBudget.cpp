@@ -0,0 +1,123 @@
+#include "VulkanEngine/MemoryBudget.h"
+#include "VulkanEngine/MemoryAllocator.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace VulkanEngine {
+
+MemoryBudget::MemoryBudget(VulkanDevice& device, MemoryAllocator& allocator)
+    : physicalDevice_(device.getPhysicalDevice()), allocator_(allocator),
+      driverBudget_(device.isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+{
+    vk::PhysicalDeviceMemoryProperties memoryProperties = physicalDevice_.getMemoryProperties();
+    heaps_.resize(memoryProperties.memoryHeapCount);
+    otherUsage_.resize(memoryProperties.memoryHeapCount, 0);
+    evictionCooldown_.resize(memoryProperties.memoryHeapCount, 0);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        heaps_[i].heapSize = memoryProperties.memoryHeaps[i].size;
+        heaps_[i].budget = static_cast<vk::DeviceSize>(heaps_[i].heapSize * ESTIMATED_BUDGET_FRACTION);
+        heaps_[i].deviceLocal = static_cast<bool>(memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+    }
+
+    if (!driverBudget_) {
+        std::cerr << "[WARN] VK_EXT_memory_budget not available, estimating memory budget from heap sizes" << std::endl;
+    }
+    update();
+}
+
+void MemoryBudget::update() {
+    // Taken before locking mutex_, the allocator calls fits() with its own lock held
+    std::vector<HeapStats> stats = allocator_.getHeapStats();
+
+    std::vector<uint32_t> heapsToEvict;
+    std::vector<vk::DeviceSize> bytesToFree;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (driverBudget_) {
+            auto chain = physicalDevice_.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2,
+                                                              vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+            const auto& budgetProperties = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+            for (size_t i = 0; i < heaps_.size(); i++) {
+                heaps_[i].usage = budgetProperties.heapUsage[i];
+                // Some drivers report a budget above the heap size
+                heaps_[i].budget = std::min(budgetProperties.heapBudget[i], heaps_[i].heapSize);
+                // The driver's usage can lag behind our own allocations for a moment
+                otherUsage_[i] = heaps_[i].usage > stats[i].blockBytes ? heaps_[i].usage - stats[i].blockBytes : 0;
+            }
+        } else {
+            for (size_t i = 0; i < heaps_.size(); i++) {
+                heaps_[i].usage = stats[i].blockBytes;
+                otherUsage_[i] = 0;
+            }
+        }
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(heaps_.size()); i++) {
+            if (evictionCooldown_[i] > 0) {
+                evictionCooldown_[i]--;
+                continue;
+            }
+            const HeapBudget& heap = heaps_[i];
+            if (heap.usage > static_cast<vk::DeviceSize>(heap.budget * EVICTION_THRESHOLD)) {
+                heapsToEvict.push_back(i);
+                bytesToFree.push_back(heap.usage - static_cast<vk::DeviceSize>(heap.budget * EVICTION_TARGET));
+                evictionCooldown_[i] = EVICTION_COOLDOWN_FRAMES;
+            }
+        }
+    }
+
+    // Outside the lock, callbacks free memory through the allocator
+    for (size_t i = 0; i < heapsToEvict.size(); i++) {
+        evict(heapsToEvict[i], bytesToFree[i]);
+    }
+}
+
+void MemoryBudget::evict(uint32_t heapIndex, vk::DeviceSize bytesToFree) {
+    vk::DeviceSize freed = 0;
+    for (const Callback& callback : callbacks_) {
+        if (freed >= bytesToFree) {
+            break;
+        }
+        freed += callback.callback(heapIndex, bytesToFree - freed);
+    }
+    if (freed < bytesToFree) {
+        std::cerr << "[WARN] Heap " << heapIndex << " is near its budget, evicted " << freed << " of "
+                  << bytesToFree << " bytes" << std::endl;
+    }
+}
+
+std::vector<HeapBudget> MemoryBudget::getHeapBudgets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return heaps_;
+}
+
+bool MemoryBudget::fits(uint32_t heapIndex, vk::DeviceSize size, vk::DeviceSize ownBytes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return otherUsage_[heapIndex] + ownBytes + size <= heaps_[heapIndex].budget;
+}
+
+uint32_t MemoryBudget::addEvictionCallback(EvictionCallback callback) {
+    uint32_t id = nextCallbackId_++;
+    callbacks_.push_back({id, std::move(callback)});
+    return id;
+}
+
+void MemoryBudget::removeEvictionCallback(uint32_t id) {
+    callbacks_.erase(std::remove_if(callbacks_.begin(), callbacks_.end(),
+                                    [id](const Callback& callback) { return callback.id == id; }),
+                     callbacks_.end());
+}
+
+void MemoryBudget::printBudget(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << "Memory budget (" << (driverBudget_ ? "VK_EXT_memory_budget" : "estimated") << "):" << std::endl;
+    for (size_t i = 0; i < heaps_.size(); i++) {
+        const HeapBudget& heap = heaps_[i];
+        out << "  Heap " << i << (heap.deviceLocal ? " (device local)" : "") << ": "
+            << heap.usage / (1024 * 1024) << " / " << heap.budget / (1024 * 1024) << " MiB used, heap size "
+            << heap.heapSize / (1024 * 1024) << " MiB" << std::endl;
+    }
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,1168 @@
+#include "VulkanEngine/MeshLoader.h"
+#include "VulkanEngine/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Murmur3's finalizer, spreads every input bit over the whole hash
+uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t hashVertex(const MeshVertex& vertex) {
+    static_assert(sizeof(MeshVertex) == 11 * sizeof(uint32_t), "MeshVertex is compared bytewise, it can't have padding");
+    uint32_t words[11];
+    std::memcpy(words, &vertex, sizeof(words));
+    uint64_t hash = 0;
+    for (uint32_t word : words) {
+        hash = mixHash(hash ^ word) + 0x9e3779b97f4a7c15ull;
+    }
+    return hash;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// Decimal number without going through the C locale: sign, digits, fraction, exponent.
+// Exact for integers up to 19 digits. Returns nullptr if there is no number at p.
+const char* parseNumber(const char* p, const char* end, double& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    auto addDigit = [&](int digit, bool fraction) {
+        if (mantissa == 0 && digit == 0) {
+            exponent -= fraction ? 1 : 0; // Leading zeros only shift the point
+        } else if (digits < 19) {
+            mantissa = mantissa * 10 + digit;
+            digits++;
+            exponent -= fraction ? 1 : 0;
+        } else if (!fraction) {
+            exponent++; // Precision ran out, keep the magnitude
+        }
+        any = true;
+    };
+    while (p < end && *p >= '0' && *p <= '9') {
+        addDigit(*p++ - '0', false);
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            addDigit(*p++ - '0', true);
+        }
+    }
+    if (!any) {
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negativeExponent = *q == '-';
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            int power = 0;
+            while (q < end && *q >= '0' && *q <= '9') {
+                power = std::min(power * 10 + (*q++ - '0'), 100000);
+            }
+            exponent += negativeExponent ? -power : power;
+            p = q;
+        }
+    }
+
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    double result = static_cast<double>(mantissa);
+    if (exponent != 0 && mantissa != 0) {
+        if (exponent > 0 && exponent <= 22) {
+            result *= powers[exponent];
+        } else if (exponent < 0 && exponent >= -22) {
+            result /= powers[-exponent];
+        } else {
+            result *= std::pow(10.0, exponent);
+        }
+    }
+    value = negative ? -result : result;
+    return p;
+}
+
+const char* parseFloat(const char* p, const char* end, float& value) {
+    double number = 0.0;
+    p = parseNumber(p, end, number);
+    value = static_cast<float>(number);
+    return p;
+}
+
+// --- OBJ ---
+
+// One triangle corner. Indices are 0-based; relative ones (negative in the file) count
+// from the first element of the chunk until the chunks are joined.
+struct ObjCorner {
+    int32_t index[3]; // Position, texture coordinate, normal; -1 if absent
+    uint32_t relative; // Bit per index
+};
+
+constexpr uint32_t OBJ_POSITION = 0;
+constexpr uint32_t OBJ_TEXCOORD = 1;
+constexpr uint32_t OBJ_NORMAL = 2;
+
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colors; // Empty unless a position of this chunk had one, then one per position
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // Three per triangle
+    bool allNormals = true; // Every corner has a normal index
+    uint32_t first[3] = {0, 0, 0}; // Global index of the chunk's first position, texture coordinate, normal
+    size_t firstCorner = 0;
+};
+
+[[noreturn]] void objError(const char* what, const char* base, const char* at) {
+    throw std::runtime_error(std::string("OBJ: ") + what + " at byte " + std::to_string(at - base));
+}
+
+void parseObjChunk(ObjChunk& chunk, const char* base) {
+    std::vector<ObjCorner> polygon;
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        if (!lineEnd) {
+            lineEnd = chunk.end;
+        }
+        const char* line = skipSpaces(p, lineEnd);
+        const char* q = line;
+        while (q < lineEnd && !isSpace(*q)) {
+            q++;
+        }
+        size_t keywordLength = q - line;
+        p = lineEnd + 1;
+        // Anything but v, vt, vn and f is skipped: comments, groups, materials, lines, points
+        if (keywordLength == 0 || keywordLength > 2 || (line[0] != 'v' && line[0] != 'f') ||
+            (keywordLength == 2 && (line[0] != 'v' || (line[1] != 't' && line[1] != 'n')))) {
+            continue;
+        }
+
+        if (keywordLength == 1 && line[0] == 'v') {
+            float values[7];
+            int count = 0;
+            while (count < 7) {
+                const char* next = parseFloat(skipSpaces(q, lineEnd), lineEnd, values[count]);
+                if (!next) {
+                    break;
+                }
+                q = next;
+                count++;
+            }
+            if (count < 3) {
+                objError("vertex with fewer than 3 coordinates", base, line);
+            }
+            chunk.positions.push_back(glm::vec3(values[0], values[1], values[2]));
+            // "v x y z r g b", colors after the position
+            if (count >= 6) {
+                if (chunk.colors.empty()) {
+                    chunk.colors.resize(chunk.positions.size() - 1, glm::vec3(1.0f));
+                }
+                chunk.colors.push_back(glm::vec3(values[3], values[4], values[5]));
+            } else if (!chunk.colors.empty()) {
+                chunk.colors.push_back(glm::vec3(1.0f));
+            }
+        } else if (keywordLength == 2 && line[1] == 't') {
+            glm::vec2 texCoord(0.0f);
+            const char* next = parseFloat(skipSpaces(q, lineEnd), lineEnd, texCoord.x);
+            if (!next) {
+                objError("texture coordinate without values", base, line);
+            }
+            parseFloat(skipSpaces(next, lineEnd), lineEnd, texCoord.y);
+            chunk.texCoords.push_back(glm::vec2(texCoord.x, 1.0f - texCoord.y)); // Top left origin, like glTF
+        } else if (keywordLength == 2) {
+            glm::vec3 normal;
+            for (int i = 0; i < 3; i++) {
+                q = parseFloat(skipSpaces(q, lineEnd), lineEnd, normal[i]);
+                if (!q) {
+                    objError("normal with fewer than 3 coordinates", base, line);
+                }
+            }
+            chunk.normals.push_back(normal);
+        } else {
+            // f: v, v/vt, v//vn or v/vt/vn per corner
+            polygon.clear();
+            for (;;) {
+                q = skipSpaces(q, lineEnd);
+                if (q >= lineEnd) {
+                    break;
+                }
+                ObjCorner corner = {{-1, -1, -1}, 0};
+                const size_t counts[3] = {chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size()};
+                for (uint32_t attribute = 0; attribute < 3; attribute++) {
+                    if (attribute > 0) {
+                        if (q >= lineEnd || *q != '/') {
+                            break;
+                        }
+                        q++;
+                        if (q < lineEnd && *q == '/') {
+                            continue; // Empty texture coordinate
+                        }
+                    }
+                    double value = 0.0;
+                    const char* next = parseNumber(q, lineEnd, value);
+                    if (!next || value == 0.0 || value != std::floor(value) || std::abs(value) > 2147483647.0) {
+                        objError("invalid face index", base, line);
+                    }
+                    q = next;
+                    int64_t index = static_cast<int64_t>(value);
+                    if (index > 0) {
+                        corner.index[attribute] = static_cast<int32_t>(index - 1);
+                    } else {
+                        int64_t relative = static_cast<int64_t>(counts[attribute]) + index;
+                        if (relative < std::numeric_limits<int32_t>::min()) {
+                            objError("invalid face index", base, line);
+                        }
+                        corner.index[attribute] = static_cast<int32_t>(relative);
+                        corner.relative |= 1u << attribute;
+                    }
+                }
+                if (corner.index[OBJ_POSITION] == -1 && !(corner.relative & (1u << OBJ_POSITION))) {
+                    objError("face corner without a position", base, line);
+                }
+                if (q < lineEnd && !isSpace(*q)) {
+                    objError("unexpected character in face", base, line);
+                }
+                polygon.push_back(corner);
+            }
+            if (polygon.size() < 3) {
+                objError("face with fewer than 3 corners", base, line);
+            }
+            for (const ObjCorner& corner : polygon) {
+                if (corner.index[OBJ_NORMAL] == -1 && !(corner.relative & (1u << OBJ_NORMAL))) {
+                    chunk.allNormals = false;
+                }
+            }
+            // Fan, fine for the convex polygons exporters write
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i]);
+                chunk.corners.push_back(polygon[i + 1]);
+            }
+        }
+    }
+}
+
+// --- JSON, just enough for glTF ---
+
+struct JsonValue {
+    enum class Type { eNull, eBool, eNumber, eString, eArray, eObject };
+
+    Type type = Type::eNull;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array; // Elements, or member values of an object
+    std::vector<std::string> keys; // Member names of an object, parallel to array
+
+    // Member of an object, nullptr if absent or not an object
+    const JsonValue* find(const char* key) const {
+        if (type != Type::eObject) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) {
+                return &array[i];
+            }
+        }
+        return nullptr;
+    }
+
+    double getNumber(const char* key, double fallback) const {
+        const JsonValue* value = find(key);
+        return value && value->type == Type::eNumber ? value->number : fallback;
+    }
+
+    // Element of an array member, nullptr if anything along the way is missing
+    const JsonValue* at(const char* key, double index) const {
+        const JsonValue* list = find(key);
+        if (!list || list->type != Type::eArray || index < 0.0 || index >= static_cast<double>(list->array.size()) ||
+            index != std::floor(index)) {
+            return nullptr;
+        }
+        return &list->array[static_cast<size_t>(index)];
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* begin, const char* end) : begin_(begin), p_(begin), end_(end) {}
+
+    JsonValue parse() {
+        JsonValue value = parseValue(0);
+        skipWhitespace();
+        if (p_ != end_ && *p_ != '\0' && *p_ != ' ') {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    static constexpr uint32_t MAX_DEPTH = 128;
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("glb: invalid JSON at byte ") + std::to_string(p_ - begin_) + ": " + what);
+    }
+
+    void skipWhitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            p_++;
+        }
+    }
+
+    void expect(const char* literal) {
+        size_t length = std::strlen(literal);
+        if (static_cast<size_t>(end_ - p_) < length || std::memcmp(p_, literal, length) != 0) {
+            fail("unexpected token");
+        }
+        p_ += length;
+    }
+
+    std::string parseString() {
+        if (p_ >= end_ || *p_ != '"') {
+            fail("expected a string");
+        }
+        p_++;
+        std::string result;
+        while (p_ < end_ && *p_ != '"') {
+            char c = *p_++;
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (p_ >= end_) {
+                break;
+            }
+            char escape = *p_++;
+            switch (escape) {
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    if (end_ - p_ < 4) {
+                        fail("truncated escape");
+                    }
+                    uint32_t code = 0;
+                    for (int i = 0; i < 4; i++) {
+                        char h = *p_++;
+                        code <<= 4;
+                        if (h >= '0' && h <= '9') code |= h - '0';
+                        else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+                        else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+                        else fail("invalid escape");
+                    }
+                    // UTF-8, surrogate pairs are left as two code points
+                    if (code < 0x80) {
+                        result += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        result += static_cast<char>(0xC0 | (code >> 6));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        result += static_cast<char>(0xE0 | (code >> 12));
+                        result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: result += escape; break; // \" \\ \/
+            }
+        }
+        if (p_ >= end_) {
+            fail("unterminated string");
+        }
+        p_++;
+        return result;
+    }
+
+    JsonValue parseValue(uint32_t depth) {
+        if (depth > MAX_DEPTH) {
+            fail("nested too deeply");
+        }
+        skipWhitespace();
+        if (p_ >= end_) {
+            fail("unexpected end");
+        }
+        JsonValue value;
+        switch (*p_) {
+            case '{':
+                value.type = JsonValue::Type::eObject;
+                p_++;
+                skipWhitespace();
+                if (p_ < end_ && *p_ == '}') {
+                    p_++;
+                    return value;
+                }
+                for (;;) {
+                    skipWhitespace();
+                    value.keys.push_back(parseString());
+                    skipWhitespace();
+                    expect(":");
+                    value.array.push_back(parseValue(depth + 1));
+                    skipWhitespace();
+                    if (p_ < end_ && *p_ == ',') {
+                        p_++;
+                        continue;
+                    }
+                    expect("}");
+                    return value;
+                }
+            case '[':
+                value.type = JsonValue::Type::eArray;
+                p_++;
+                skipWhitespace();
+                if (p_ < end_ && *p_ == ']') {
+                    p_++;
+                    return value;
+                }
+                for (;;) {
+                    value.array.push_back(parseValue(depth + 1));
+                    skipWhitespace();
+                    if (p_ < end_ && *p_ == ',') {
+                        p_++;
+                        continue;
+                    }
+                    expect("]");
+                    return value;
+                }
+            case '"':
+                value.type = JsonValue::Type::eString;
+                value.string = parseString();
+                return value;
+            case 't':
+                expect("true");
+                value.type = JsonValue::Type::eBool;
+                value.boolean = true;
+                return value;
+            case 'f':
+                expect("false");
+                value.type = JsonValue::Type::eBool;
+                return value;
+            case 'n':
+                expect("null");
+                return value;
+            default: {
+                const char* next = parseNumber(p_, end_, value.number);
+                if (!next) {
+                    fail("unexpected character");
+                }
+                value.type = JsonValue::Type::eNumber;
+                p_ = next;
+                return value;
+            }
+        }
+    }
+
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+};
+
+// --- glTF ---
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+constexpr uint32_t GLTF_BYTE = 5120;
+constexpr uint32_t GLTF_UNSIGNED_BYTE = 5121;
+constexpr uint32_t GLTF_SHORT = 5122;
+constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123;
+constexpr uint32_t GLTF_UNSIGNED_INT = 5125;
+constexpr uint32_t GLTF_FLOAT = 5126;
+constexpr uint32_t GLTF_TRIANGLES = 4;
+
+// Elements of an accessor, resolved to bytes in the binary chunk
+struct GltfAccessor {
+    const uint8_t* data = nullptr; // nullptr reads as zeros (no bufferView)
+    size_t count = 0;
+    size_t stride = 0;
+    uint32_t componentType = GLTF_FLOAT;
+    uint32_t components = 0;
+    bool normalized = false;
+
+    float readComponent(size_t element, uint32_t component) const {
+        if (!data) {
+            return 0.0f;
+        }
+        const uint8_t* p = data + element * stride;
+        switch (componentType) {
+            case GLTF_FLOAT: {
+                float value;
+                std::memcpy(&value, p + component * 4, 4);
+                return value;
+            }
+            case GLTF_UNSIGNED_BYTE: {
+                float value = p[component];
+                return normalized ? value / 255.0f : value;
+            }
+            case GLTF_BYTE: {
+                float value = static_cast<int8_t>(p[component]);
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t value;
+                std::memcpy(&value, p + component * 2, 2);
+                return normalized ? value / 65535.0f : value;
+            }
+            case GLTF_SHORT: {
+                int16_t value;
+                std::memcpy(&value, p + component * 2, 2);
+                return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            default: {
+                uint32_t value;
+                std::memcpy(&value, p + component * 4, 4);
+                return static_cast<float>(value);
+            }
+        }
+    }
+
+    glm::vec4 read(size_t element) const {
+        glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+        for (uint32_t component = 0; component < components; component++) {
+            value[component] = readComponent(element, component);
+        }
+        return value;
+    }
+
+    uint32_t readIndex(size_t element) const {
+        if (!data) {
+            return 0;
+        }
+        const uint8_t* p = data + element * stride;
+        if (componentType == GLTF_UNSIGNED_BYTE) {
+            return *p;
+        }
+        if (componentType == GLTF_UNSIGNED_SHORT) {
+            uint16_t value;
+            std::memcpy(&value, p, 2);
+            return value;
+        }
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+};
+
+[[noreturn]] void glbError(const std::string& what) {
+    throw std::runtime_error("glb: " + what);
+}
+
+GltfAccessor getAccessor(const JsonValue& root, double index, const uint8_t* bin, size_t binSize) {
+    const JsonValue* accessor = root.at("accessors", index);
+    if (!accessor) {
+        glbError("missing accessor " + std::to_string(index));
+    }
+    if (accessor->find("sparse")) {
+        glbError("sparse accessors are not supported");
+    }
+
+    double count = accessor->getNumber("count", -1.0);
+    if (count < 0.0 || count != std::floor(count) || count >= 4294967296.0) {
+        glbError("invalid accessor count");
+    }
+    GltfAccessor result;
+    result.count = static_cast<size_t>(count);
+    result.componentType = static_cast<uint32_t>(accessor->getNumber("componentType", 0.0));
+    const JsonValue* normalized = accessor->find("normalized");
+    result.normalized = normalized && normalized->boolean;
+    const JsonValue* type = accessor->find("type");
+    std::string typeName = type ? type->string : "";
+    result.components = typeName == "SCALAR" ? 1 : typeName == "VEC2" ? 2 : typeName == "VEC3" ? 3 : typeName == "VEC4" ? 4 : 0;
+    if (result.components == 0) {
+        glbError("unsupported accessor type \"" + typeName + "\"");
+    }
+    size_t componentSize = 0;
+    switch (result.componentType) {
+        case GLTF_BYTE: case GLTF_UNSIGNED_BYTE: componentSize = 1; break;
+        case GLTF_SHORT: case GLTF_UNSIGNED_SHORT: componentSize = 2; break;
+        case GLTF_UNSIGNED_INT: case GLTF_FLOAT: componentSize = 4; break;
+        default: glbError("unsupported component type " + std::to_string(result.componentType));
+    }
+    size_t elementSize = componentSize * result.components;
+
+    const JsonValue* viewIndex = accessor->find("bufferView");
+    if (!viewIndex) {
+        return result; // All zeros
+    }
+    const JsonValue* view = root.at("bufferViews", viewIndex->number);
+    if (!view) {
+        glbError("missing buffer view");
+    }
+    const JsonValue* buffer = root.at("buffers", view->getNumber("buffer", 0.0));
+    if (view->getNumber("buffer", 0.0) != 0.0 || !buffer || buffer->find("uri")) {
+        glbError("only the binary chunk is supported as a buffer");
+    }
+    double viewOffset = view->getNumber("byteOffset", 0.0);
+    double viewLength = view->getNumber("byteLength", 0.0);
+    double accessorOffset = accessor->getNumber("byteOffset", 0.0);
+    double stride = view->getNumber("byteStride", static_cast<double>(elementSize));
+    if (viewOffset < 0.0 || viewLength < 0.0 || accessorOffset < 0.0 || viewOffset + viewLength > static_cast<double>(binSize) ||
+        stride < static_cast<double>(elementSize) || stride > 252.0) {
+        glbError("buffer view out of range");
+    }
+    result.stride = static_cast<size_t>(stride);
+    if (result.count > 0 &&
+        accessorOffset + static_cast<double>(result.stride) * (result.count - 1) + elementSize > viewLength) {
+        glbError("accessor out of range of its buffer view");
+    }
+    result.data = bin + static_cast<size_t>(viewOffset) + static_cast<size_t>(accessorOffset);
+    return result;
+}
+
+glm::mat4 getNodeTransform(const JsonValue& node) {
+    glm::mat4 transform(1.0f);
+    const JsonValue* matrix = node.find("matrix");
+    if (matrix && matrix->array.size() == 16) {
+        for (int i = 0; i < 16; i++) {
+            transform[i / 4][i % 4] = static_cast<float>(matrix->array[i].number); // Column major
+        }
+        return transform;
+    }
+    auto readVector = [&node](const char* key, glm::vec4 value) {
+        const JsonValue* list = node.find(key);
+        for (size_t i = 0; list && i < list->array.size() && i < 4; i++) {
+            value[static_cast<int>(i)] = static_cast<float>(list->array[i].number);
+        }
+        return value;
+    };
+    glm::vec4 translation = readVector("translation", glm::vec4(0.0f));
+    glm::vec4 rotation = readVector("rotation", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)); // x, y, z, w
+    glm::vec4 scale = readVector("scale", glm::vec4(1.0f));
+
+    // T * R * S, with R from the unit quaternion
+    float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+    transform[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f) * scale.x;
+    transform[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f) * scale.y;
+    transform[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f) * scale.z;
+    transform[3] = glm::vec4(translation.x, translation.y, translation.z, 1.0f);
+    return transform;
+}
+
+// A triangle primitive of a mesh instance, and where its data goes in the output
+struct GlbPrimitive {
+    GltfAccessor positions;
+    GltfAccessor normals; // components 0 if absent
+    GltfAccessor colors;
+    GltfAccessor texCoords;
+    GltfAccessor indices; // count 0 without indices
+    glm::mat4 transform;
+    glm::mat3 normalTransform;
+    bool flipWinding; // Mirroring transform
+    size_t indexCount;
+    size_t firstVertex;
+    size_t firstIndex;
+};
+
+// A range of one primitive's vertices or indices, the unit of parallel work
+struct GlbBatch {
+    uint32_t primitive;
+    bool indices;
+    size_t begin;
+    size_t end;
+};
+
+} // namespace
+
+MeshLoader::MeshLoader(JobSystem& jobSystem) : jobSystem_(jobSystem) {}
+
+MeshData MeshLoader::loadFile(const std::string& path) {
+    auto start = Clock::now();
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open mesh file: " + path);
+    }
+    std::vector<char> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to read mesh file: " + path);
+    }
+
+    MeshData mesh = load(bytes.data(), bytes.size(), path);
+    stats_.totalMs = elapsedMs(start);
+    return mesh;
+}
+
+MeshData MeshLoader::load(const void* data, size_t size, const std::string& name) {
+    std::string extension = name.substr(std::min(name.size(), name.find_last_of('.')));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    if (extension == ".obj") {
+        return loadObj(data, size);
+    }
+    if (extension == ".glb") {
+        return loadGlb(data, size);
+    }
+    throw std::runtime_error("Unsupported mesh format: " + name + " (expected .obj or .glb)");
+}
+
+MeshData MeshLoader::loadObj(const void* data, size_t size) {
+    auto start = Clock::now();
+    stats_ = MeshLoadStats{};
+    stats_.bytes = size;
+    const char* text = static_cast<const char*>(data);
+
+    // Chunks end at line breaks so no line is split between two jobs
+    std::vector<ObjChunk> chunks;
+    for (size_t offset = 0; offset < size;) {
+        size_t end = std::min(size, offset + OBJ_CHUNK_BYTES);
+        const char* lineEnd = static_cast<const char*>(std::memchr(text + end, '\n', size - end));
+        end = lineEnd ? static_cast<size_t>(lineEnd - text) + 1 : size;
+        ObjChunk chunk;
+        chunk.begin = text + offset;
+        chunk.end = text + end;
+        chunks.push_back(std::move(chunk));
+        offset = end;
+    }
+    jobSystem_.parallelFor(static_cast<uint32_t>(chunks.size()), 1, [&chunks, text](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            parseObjChunk(chunks[i], text);
+        }
+    });
+
+    // Where every chunk's elements land once joined
+    size_t totals[3] = {0, 0, 0};
+    size_t cornerCount = 0;
+    bool hasColors = false;
+    bool allNormals = true;
+    for (ObjChunk& chunk : chunks) {
+        const size_t counts[3] = {chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size()};
+        for (uint32_t attribute = 0; attribute < 3; attribute++) {
+            chunk.first[attribute] = static_cast<uint32_t>(totals[attribute]);
+            totals[attribute] += counts[attribute];
+        }
+        chunk.firstCorner = cornerCount;
+        cornerCount += chunk.corners.size();
+        hasColors = hasColors || !chunk.colors.empty();
+        allNormals = allNormals && chunk.allNormals;
+    }
+    if (totals[OBJ_POSITION] > static_cast<size_t>(std::numeric_limits<int32_t>::max()) ||
+        cornerCount >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("OBJ: too large, more than 2^31 vertices or 2^32 corners");
+    }
+
+    // Join the chunks, resolving and checking the indices and hashing the corners on the way
+    std::vector<glm::vec3> positions(totals[OBJ_POSITION]);
+    std::vector<glm::vec3> colors(hasColors ? totals[OBJ_POSITION] : 0);
+    std::vector<glm::vec2> texCoords(totals[OBJ_TEXCOORD]);
+    std::vector<glm::vec3> normals(totals[OBJ_NORMAL]);
+    std::vector<ObjCorner> corners(cornerCount);
+    std::vector<uint64_t> hashes(cornerCount);
+    jobSystem_.parallelFor(static_cast<uint32_t>(chunks.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const ObjChunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.first[OBJ_POSITION]);
+            if (hasColors) {
+                if (chunk.colors.empty()) {
+                    std::fill_n(colors.begin() + chunk.first[OBJ_POSITION], chunk.positions.size(), glm::vec3(1.0f));
+                } else {
+                    std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin() + chunk.first[OBJ_POSITION]);
+                }
+            }
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.first[OBJ_TEXCOORD]);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.first[OBJ_NORMAL]);
+
+            for (size_t c = 0; c < chunk.corners.size(); c++) {
+                ObjCorner corner = chunk.corners[c];
+                for (uint32_t attribute = 0; attribute < 3; attribute++) {
+                    int64_t index = corner.index[attribute];
+                    if (corner.relative & (1u << attribute)) {
+                        index += chunk.first[attribute];
+                    } else if (index == -1) {
+                        continue;
+                    }
+                    if (index < 0 || static_cast<size_t>(index) >= totals[attribute]) {
+                        throw std::runtime_error("OBJ: face refers to a missing vertex, texture coordinate or normal");
+                    }
+                    corner.index[attribute] = static_cast<int32_t>(index);
+                }
+                corner.relative = 0;
+                // Without normals everywhere they are all computed, so don't let them split vertices
+                if (!allNormals) {
+                    corner.index[OBJ_NORMAL] = -1;
+                }
+                corners[chunk.firstCorner + c] = corner;
+                hashes[chunk.firstCorner + c] = mixHash(static_cast<uint32_t>(corner.index[OBJ_POSITION]) |
+                                                        static_cast<uint64_t>(static_cast<uint32_t>(corner.index[OBJ_TEXCOORD])) << 32) ^
+                                                mixHash(static_cast<uint32_t>(corner.index[OBJ_NORMAL]) + 0x9e3779b97f4a7c15ull);
+            }
+        }
+    });
+    chunks.clear();
+    chunks.shrink_to_fit();
+    stats_.parseMs = elapsedMs(start);
+
+    auto dedupStart = Clock::now();
+    std::vector<uint32_t> firstCorners;
+    std::vector<uint32_t> remap = deduplicate(hashes, [&corners](uint32_t a, uint32_t b) {
+        return corners[a].index[0] == corners[b].index[0] && corners[a].index[1] == corners[b].index[1] &&
+               corners[a].index[2] == corners[b].index[2];
+    }, firstCorners);
+
+    MeshData mesh;
+    mesh.hasColors = hasColors;
+    mesh.indices = std::move(remap);
+    mesh.vertices.resize(firstCorners.size());
+    jobSystem_.parallelFor(static_cast<uint32_t>(firstCorners.size()), 4096, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t v = begin; v < end; v++) {
+            const ObjCorner& corner = corners[firstCorners[v]];
+            MeshVertex& vertex = mesh.vertices[v];
+            vertex.position = positions[corner.index[OBJ_POSITION]];
+            vertex.color = hasColors ? colors[corner.index[OBJ_POSITION]] : glm::vec3(1.0f);
+            vertex.texCoord = corner.index[OBJ_TEXCOORD] >= 0 ? texCoords[corner.index[OBJ_TEXCOORD]] : glm::vec2(0.0f);
+            vertex.normal = corner.index[OBJ_NORMAL] >= 0 ? normals[corner.index[OBJ_NORMAL]] : glm::vec3(0.0f);
+        }
+    });
+    if (!allNormals) {
+        computeNormals(mesh);
+    }
+    stats_.dedupMs = elapsedMs(dedupStart);
+
+    stats_.triangles = mesh.indices.size() / 3;
+    stats_.vertices = static_cast<uint32_t>(mesh.vertices.size());
+    stats_.corners = cornerCount;
+    stats_.totalMs = elapsedMs(start);
+    return mesh;
+}
+
+MeshData MeshLoader::loadGlb(const void* data, size_t size) {
+    auto start = Clock::now();
+    stats_ = MeshLoadStats{};
+    stats_.bytes = size;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    auto readU32 = [bytes](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, bytes + offset, 4);
+        return value;
+    };
+
+    // 12 byte header, then a JSON chunk and an optional binary chunk
+    if (size < 20 || readU32(0) != GLB_MAGIC) {
+        glbError("not a binary glTF file");
+    }
+    if (readU32(4) != 2) {
+        glbError("unsupported version " + std::to_string(readU32(4)));
+    }
+    size_t length = std::min<size_t>(readU32(8), size);
+    const char* json = nullptr;
+    size_t jsonSize = 0;
+    const uint8_t* bin = nullptr;
+    size_t binSize = 0;
+    for (size_t offset = 12; offset + 8 <= length;) {
+        size_t chunkLength = readU32(offset);
+        uint32_t chunkType = readU32(offset + 4);
+        if (chunkLength > length - offset - 8) {
+            glbError("chunk out of range");
+        }
+        if (chunkType == GLB_CHUNK_JSON && !json) {
+            json = reinterpret_cast<const char*>(bytes + offset + 8);
+            jsonSize = chunkLength;
+        } else if (chunkType == GLB_CHUNK_BIN && !bin) {
+            bin = bytes + offset + 8;
+            binSize = chunkLength;
+        }
+        offset += 8 + (chunkLength + 3) / 4 * 4;
+    }
+    if (!json) {
+        glbError("no JSON chunk");
+    }
+    JsonValue root = JsonParser(json, json + jsonSize).parse();
+
+    // Mesh instances of the default scene, with their world transforms
+    std::vector<std::pair<double, glm::mat4>> instances;
+    const JsonValue* scenes = root.find("scenes");
+    if (scenes && scenes->type == JsonValue::Type::eArray && !scenes->array.empty()) {
+        const JsonValue* scene = root.at("scenes", root.getNumber("scene", 0.0));
+        if (!scene) {
+            glbError("missing default scene");
+        }
+        struct Pending {
+            double node;
+            glm::mat4 parent;
+            uint32_t depth;
+        };
+        std::vector<Pending> stack;
+        const JsonValue* sceneNodes = scene->find("nodes");
+        for (size_t i = 0; sceneNodes && i < sceneNodes->array.size(); i++) {
+            stack.push_back({sceneNodes->array[i].number, glm::mat4(1.0f), 0});
+        }
+        while (!stack.empty()) {
+            Pending pending = stack.back();
+            stack.pop_back();
+            const JsonValue* node = root.at("nodes", pending.node);
+            if (!node || pending.depth > 64) {
+                glbError("invalid node hierarchy");
+            }
+            glm::mat4 world = pending.parent * getNodeTransform(*node);
+            if (const JsonValue* mesh = node->find("mesh")) {
+                instances.push_back({mesh->number, world});
+            }
+            const JsonValue* children = node->find("children");
+            for (size_t i = 0; children && i < children->array.size(); i++) {
+                stack.push_back({children->array[i].number, world, pending.depth + 1});
+            }
+        }
+    } else if (const JsonValue* meshes = root.find("meshes")) {
+        // No scene: every mesh once, untransformed
+        for (size_t i = 0; i < meshes->array.size(); i++) {
+            instances.push_back({static_cast<double>(i), glm::mat4(1.0f)});
+        }
+    }
+
+    std::vector<GlbPrimitive> primitives;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    bool hasColors = false;
+    bool allNormals = true;
+    for (const auto& instance : instances) {
+        const JsonValue* mesh = root.at("meshes", instance.first);
+        const JsonValue* meshPrimitives = mesh ? mesh->find("primitives") : nullptr;
+        if (!meshPrimitives) {
+            glbError("missing mesh");
+        }
+        for (const JsonValue& primitive : meshPrimitives->array) {
+            double mode = primitive.getNumber("mode", GLTF_TRIANGLES);
+            const JsonValue* attributes = primitive.find("attributes");
+            const JsonValue* position = attributes ? attributes->find("POSITION") : nullptr;
+            if (mode != GLTF_TRIANGLES || !position) {
+                std::cerr << "[WARN] glb: skipping a primitive that isn't a triangle list with positions" << std::endl;
+                continue;
+            }
+
+            GlbPrimitive result;
+            result.positions = getAccessor(root, position->number, bin, binSize);
+            size_t count = result.positions.count;
+            auto optionalAccessor = [&](const char* name) {
+                const JsonValue* attribute = attributes->find(name);
+                GltfAccessor accessor = attribute ? getAccessor(root, attribute->number, bin, binSize) : GltfAccessor{};
+                if (attribute && accessor.count != count) {
+                    glbError(std::string(name) + " count differs from POSITION");
+                }
+                return accessor;
+            };
+            result.normals = optionalAccessor("NORMAL");
+            result.colors = optionalAccessor("COLOR_0");
+            result.texCoords = optionalAccessor("TEXCOORD_0");
+            if (result.positions.components != 3 || (result.normals.components != 0 && result.normals.components != 3) ||
+                result.colors.components == 1 || result.colors.components == 2 ||
+                (result.texCoords.components != 0 && result.texCoords.components != 2)) {
+                glbError("unexpected attribute type");
+            }
+            if (const JsonValue* indices = primitive.find("indices")) {
+                result.indices = getAccessor(root, indices->number, bin, binSize);
+                uint32_t type = result.indices.componentType;
+                if (result.indices.components != 1 ||
+                    (type != GLTF_UNSIGNED_BYTE && type != GLTF_UNSIGNED_SHORT && type != GLTF_UNSIGNED_INT)) {
+                    glbError("indices have to be unsigned scalars");
+                }
+                result.indexCount = result.indices.count;
+            } else {
+                result.indexCount = count;
+            }
+            if (result.indexCount % 3 != 0) {
+                glbError("triangle list with an index count that isn't a multiple of 3");
+            }
+
+            result.transform = instance.second;
+            result.normalTransform = glm::transpose(glm::inverse(glm::mat3(instance.second)));
+            result.flipWinding = glm::determinant(glm::mat3(instance.second)) < 0.0f;
+            result.firstVertex = vertexCount;
+            result.firstIndex = indexCount;
+            vertexCount += count;
+            indexCount += result.indexCount;
+            hasColors = hasColors || result.colors.components != 0;
+            allNormals = allNormals && result.normals.components != 0;
+            primitives.push_back(result);
+        }
+    }
+    if (vertexCount >= std::numeric_limits<uint32_t>::max() || indexCount >= std::numeric_limits<uint32_t>::max()) {
+        glbError("too large, more than 2^32 vertices or indices");
+    }
+
+    // Convert in batches over all primitives: vertices into world space, indices offset to
+    // the primitive's first vertex and checked
+    std::vector<GlbBatch> batches;
+    for (uint32_t p = 0; p < primitives.size(); p++) {
+        for (size_t begin = 0; begin < primitives[p].positions.count; begin += GLB_BATCH_VERTICES) {
+            batches.push_back({p, false, begin, std::min<size_t>(begin + GLB_BATCH_VERTICES, primitives[p].positions.count)});
+        }
+        for (size_t begin = 0; begin < primitives[p].indexCount; begin += GLB_BATCH_VERTICES * 3) {
+            batches.push_back({p, true, begin, std::min<size_t>(begin + GLB_BATCH_VERTICES * 3, primitives[p].indexCount)});
+        }
+    }
+    std::vector<MeshVertex> vertices(vertexCount);
+    std::vector<uint64_t> hashes(vertexCount);
+    std::vector<uint32_t> indices(indexCount);
+    jobSystem_.parallelFor(static_cast<uint32_t>(batches.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t b = begin; b < end; b++) {
+            const GlbBatch& batch = batches[b];
+            const GlbPrimitive& primitive = primitives[batch.primitive];
+            if (!batch.indices) {
+                for (size_t i = batch.begin; i < batch.end; i++) {
+                    MeshVertex vertex;
+                    vertex.position = glm::vec3(primitive.transform * glm::vec4(glm::vec3(primitive.positions.read(i)), 1.0f));
+                    vertex.normal = glm::vec3(0.0f);
+                    if (allNormals) {
+                        glm::vec3 normal = primitive.normalTransform * glm::vec3(primitive.normals.read(i));
+                        float length = glm::length(normal);
+                        vertex.normal = length > 0.0f ? normal / length : normal;
+                    }
+                    vertex.color = primitive.colors.components != 0 ? glm::vec3(primitive.colors.read(i)) : glm::vec3(1.0f);
+                    vertex.texCoord = glm::vec2(primitive.texCoords.read(i));
+                    vertices[primitive.firstVertex + i] = vertex;
+                    hashes[primitive.firstVertex + i] = hashVertex(vertex);
+                }
+            } else {
+                size_t count = primitive.positions.count;
+                for (size_t i = batch.begin; i < batch.end; i++) {
+                    // Mirrored instances swap the last two corners of every triangle to stay front facing
+                    size_t source = primitive.flipWinding && i % 3 != 0 ? i + (i % 3 == 1 ? 1 : -1) : i;
+                    size_t index = primitive.indices.count > 0 ? primitive.indices.readIndex(source) : source;
+                    if (index >= count) {
+                        throw std::runtime_error("glb: index out of range");
+                    }
+                    indices[primitive.firstIndex + i] = static_cast<uint32_t>(primitive.firstVertex + index);
+                }
+            }
+        }
+    });
+    stats_.parseMs = elapsedMs(start);
+
+    // Primitives that share vertices, and vertices repeated within one, are merged
+    auto dedupStart = Clock::now();
+    std::vector<uint32_t> firstCorners;
+    std::vector<uint32_t> remap = deduplicate(hashes, [&vertices](uint32_t a, uint32_t b) {
+        return std::memcmp(&vertices[a], &vertices[b], sizeof(MeshVertex)) == 0;
+    }, firstCorners);
+
+    MeshData mesh;
+    mesh.hasColors = hasColors;
+    mesh.vertices.resize(firstCorners.size());
+    mesh.indices = std::move(indices);
+    jobSystem_.parallelFor(static_cast<uint32_t>(firstCorners.size()), 4096, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t v = begin; v < end; v++) {
+            mesh.vertices[v] = vertices[firstCorners[v]];
+        }
+    });
+    jobSystem_.parallelFor(static_cast<uint32_t>(mesh.indices.size()), 16384, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            mesh.indices[i] = remap[mesh.indices[i]];
+        }
+    });
+    if (!allNormals) {
+        computeNormals(mesh);
+    }
+    stats_.dedupMs = elapsedMs(dedupStart);
+
+    stats_.triangles = mesh.indices.size() / 3;
+    stats_.vertices = static_cast<uint32_t>(mesh.vertices.size());
+    stats_.corners = indexCount;
+    stats_.totalMs = elapsedMs(start);
+    return mesh;
+}
+
+template <typename Equal>
+std::vector<uint32_t> MeshLoader::deduplicate(const std::vector<uint64_t>& hashes, Equal equal,
+                                              std::vector<uint32_t>& firstCorners) {
+    // Open addressing with linear probing, at most half full. Slots keep the upper hash
+    // bits, so most mismatches are rejected without touching the corners.
+    struct Slot {
+        uint32_t vertex;
+        uint32_t hashBits;
+    };
+    size_t capacity = 16;
+    while (capacity < hashes.size() * 2) {
+        capacity *= 2;
+    }
+    std::vector<Slot> table(capacity, Slot{~0u, 0});
+    size_t mask = capacity - 1;
+
+    std::vector<uint32_t> remap(hashes.size());
+    firstCorners.clear();
+    for (uint32_t corner = 0; corner < hashes.size(); corner++) {
+        uint64_t hash = hashes[corner];
+        uint32_t hashBits = static_cast<uint32_t>(hash >> 32);
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            Slot& entry = table[slot];
+            if (entry.vertex == ~0u) {
+                entry.vertex = static_cast<uint32_t>(firstCorners.size());
+                entry.hashBits = hashBits;
+                firstCorners.push_back(corner);
+                remap[corner] = entry.vertex;
+                break;
+            }
+            if (entry.hashBits == hashBits && equal(firstCorners[entry.vertex], corner)) {
+                remap[corner] = entry.vertex;
+                break;
+            }
+        }
+    }
+    return remap;
+}
+
+void MeshLoader::computeNormals(MeshData& mesh) {
+    // Area weighted: the cross product's length is twice the triangle's area
+    for (MeshVertex& vertex : mesh.vertices) {
+        vertex.normal = glm::vec3(0.0f);
+    }
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        MeshVertex& a = mesh.vertices[mesh.indices[i]];
+        MeshVertex& b = mesh.vertices[mesh.indices[i + 1]];
+        MeshVertex& c = mesh.vertices[mesh.indices[i + 2]];
+        glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+        a.normal += normal;
+        b.normal += normal;
+        c.normal += normal;
+    }
+    for (MeshVertex& vertex : mesh.vertices) {
+        float length = glm::length(vertex.normal);
+        vertex.normal = length > 0.0f ? vertex.normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+}
+
+} // namespace VulkanEngine
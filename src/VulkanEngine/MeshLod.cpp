@@ -0,0 +1,31 @@
+#include "VulkanEngine/MeshLod.h"
+#include "VulkanEngine/MeshSimplifier.h"
+
+namespace VulkanEngine {
+
+LodChain LodChain::build(const float* positions, size_t vertexCount, size_t stride, const std::vector<uint32_t>& indices,
+                         uint32_t minTriangles, float maxError) {
+    LodChain chain;
+    chain.indices = indices;
+    chain.lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+    MeshSimplifier simplifier(positions, vertexCount, stride, indices);
+    while (chain.lods.size() < MAX_LODS) {
+        size_t previous = chain.lods.back().indexCount;
+        size_t target = previous / 2 / 3 * 3;
+        if (target < minTriangles * 3) {
+            break;
+        }
+        const std::vector<uint32_t>& simplified = simplifier.simplify(target, maxError);
+        // Less than a quarter fewer triangles isn't worth a level
+        if (simplified.size() * 4 > previous * 3) {
+            break;
+        }
+        chain.lods.push_back({static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(simplified.size()),
+                              simplifier.getError()});
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+    }
+    return chain;
+}
+
+} // namespace VulkanEngine
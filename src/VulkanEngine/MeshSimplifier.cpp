@@ -0,0 +1,316 @@
+#include "VulkanEngine/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace VulkanEngine {
+
+namespace {
+
+struct PositionKey {
+    uint32_t bits[3];
+
+    bool operator==(const PositionKey& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t bits : key.bits) {
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+// Smallest cosine between a triangle's normal before and after a collapse. Anything below
+// folds the surface over or leaves a sliver.
+constexpr float MIN_NORMAL_COSINE = 0.25f;
+
+} // namespace
+
+void MeshSimplifier::Quadric::add(const Quadric& other) {
+    a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+    a11 += other.a11; a12 += other.a12; a13 += other.a13;
+    a22 += other.a22; a23 += other.a23;
+    a33 += other.a33;
+    weight += other.weight;
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::vec3& point) const {
+    double x = point.x, y = point.y, z = point.z;
+    // v^T A v with v = (x, y, z, 1)
+    return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+           a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+           a22 * z * z + 2.0 * a23 * z +
+           a33;
+}
+
+MeshSimplifier::MeshSimplifier(const float* positions, size_t vertexCount, size_t stride, std::vector<uint32_t> indices)
+    : indices_(std::move(indices))
+{
+    positions_.resize(vertexCount);
+    const char* bytes = reinterpret_cast<const char*>(positions);
+    for (size_t i = 0; i < vertexCount; i++) {
+        std::memcpy(&positions_[i], bytes + i * stride, sizeof(glm::vec3));
+    }
+
+    // Vertices sharing a position are one point of the surface; more than one means a seam
+    positionIds_.resize(vertexCount);
+    locked_.assign(vertexCount, 0);
+    std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstAtPosition;
+    firstAtPosition.reserve(vertexCount);
+    std::vector<uint32_t> verticesAtPosition(vertexCount, 0);
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        PositionKey key;
+        std::memcpy(key.bits, &positions_[i], sizeof(key.bits));
+        uint32_t id = firstAtPosition.emplace(key, i).first->second;
+        positionIds_[i] = id;
+        verticesAtPosition[id]++;
+    }
+
+    // Edges with a single triangle are on a border
+    std::vector<uint64_t> edges;
+    edges.reserve(indices_.size());
+    for (size_t i = 0; i + 2 < indices_.size(); i += 3) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = positionIds_[indices_[i + corner]];
+            uint32_t b = positionIds_[indices_[i + (corner + 1) % 3]];
+            edges.push_back(edgeKey(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::vector<uint8_t> lockedPositions(vertexCount, 0);
+    for (size_t i = 0; i < edges.size();) {
+        size_t end = i + 1;
+        while (end < edges.size() && edges[end] == edges[i]) {
+            end++;
+        }
+        if (end - i == 1) {
+            lockedPositions[edges[i] >> 32] = 1;
+            lockedPositions[edges[i] & 0xFFFFFFFFu] = 1;
+        }
+        i = end;
+    }
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        uint32_t id = positionIds_[i];
+        locked_[i] = lockedPositions[id] || verticesAtPosition[id] > 1;
+    }
+
+    quadrics_.assign(vertexCount, Quadric{});
+    addTriangleQuadrics();
+}
+
+void MeshSimplifier::addTriangleQuadrics() {
+    for (size_t i = 0; i + 2 < indices_.size(); i += 3) {
+        const glm::vec3& p0 = positions_[indices_[i]];
+        const glm::vec3& p1 = positions_[indices_[i + 1]];
+        const glm::vec3& p2 = positions_[indices_[i + 2]];
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f) {
+            continue;
+        }
+        // Plane quadric weighted by the triangle's area, so big faces resist more
+        double area = 0.5 * length;
+        double nx = normal.x / length, ny = normal.y / length, nz = normal.z / length;
+        double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+        Quadric quadric{area * nx * nx, area * nx * ny, area * nx * nz, area * nx * d,
+                        area * ny * ny, area * ny * nz, area * ny * d,
+                        area * nz * nz, area * nz * d,
+                        area * d * d,
+                        area};
+        for (int corner = 0; corner < 3; corner++) {
+            quadrics_[positionIds_[indices_[i + corner]]].add(quadric);
+        }
+    }
+}
+
+float MeshSimplifier::getError() const {
+    return static_cast<float>(std::sqrt(maxCost_));
+}
+
+bool MeshSimplifier::isValidCollapse(uint32_t from, uint32_t to, const std::vector<uint32_t>& adjacencyOffsets,
+                                     const std::vector<uint32_t>& adjacency) const {
+    // Link condition: an edge inside the surface has two opposite vertices. More vertices
+    // connected to both ends means the collapse would pinch the surface together.
+    uint32_t common = 0;
+    for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++) {
+        const uint32_t* triangle = &indices_[adjacency[j] * 3];
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t vertex = triangle[corner];
+            if (vertex == from || vertex == to) {
+                continue;
+            }
+            bool seen = false;
+            for (uint32_t k = adjacencyOffsets[from]; k < j && !seen; k++) {
+                const uint32_t* earlier = &indices_[adjacency[k] * 3];
+                seen = earlier[0] == vertex || earlier[1] == vertex || earlier[2] == vertex;
+            }
+            for (int other = 0; other < corner && !seen; other++) {
+                seen = triangle[other] == vertex;
+            }
+            if (seen) {
+                continue;
+            }
+            for (uint32_t k = adjacencyOffsets[to]; k < adjacencyOffsets[to + 1]; k++) {
+                const uint32_t* around = &indices_[adjacency[k] * 3];
+                if (around[0] == vertex || around[1] == vertex || around[2] == vertex) {
+                    common++;
+                    break;
+                }
+            }
+        }
+    }
+    if (common > 2) {
+        return false;
+    }
+
+    // No triangle may fold over or collapse into a sliver
+    for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++) {
+        const uint32_t* triangle = &indices_[adjacency[j] * 3];
+        if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+            continue; // Disappears with the collapse
+        }
+        glm::vec3 corners[3];
+        glm::vec3 moved[3];
+        for (int corner = 0; corner < 3; corner++) {
+            corners[corner] = positions_[triangle[corner]];
+            moved[corner] = triangle[corner] == from ? positions_[to] : corners[corner];
+        }
+        glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+        float lengths = glm::length(before) * glm::length(after);
+        if (lengths <= 0.0f || glm::dot(before, after) < MIN_NORMAL_COSINE * lengths) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<uint32_t>& MeshSimplifier::simplify(size_t targetIndexCount, float maxError) {
+    double maxCost = static_cast<double>(maxError) * maxError;
+    size_t vertexCount = positions_.size();
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTo(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+
+    // Passes of independent collapses: each vertex takes part in at most one per pass, so the
+    // checks made against the mesh at the start of the pass stay valid
+    while (indices_.size() > targetIndexCount) {
+        uint32_t triangleCount = static_cast<uint32_t>(indices_.size() / 3);
+
+        adjacencyOffsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : indices_) {
+            adjacencyOffsets[index + 1]++;
+        }
+        for (size_t i = 0; i < vertexCount; i++) {
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        }
+        adjacency.resize(indices_.size());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                adjacency[fill[indices_[t * 3 + corner]]++] = t;
+            }
+        }
+
+        // Cheaper direction of every edge that can collapse at all
+        collapses.clear();
+        for (uint32_t t = 0; t < triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t a = indices_[t * 3 + corner];
+                uint32_t b = indices_[t * 3 + (corner + 1) % 3];
+                if (a > b || (locked_[a] && locked_[b])) {
+                    continue; // The other triangle on the edge has it as a < b
+                }
+                Quadric combined = quadrics_[positionIds_[a]];
+                combined.add(quadrics_[positionIds_[b]]);
+                double weight = std::max(combined.weight, 1e-12);
+                Collapse best{0, 0, -1.0};
+                if (!locked_[a]) {
+                    best = {a, b, std::max(0.0, combined.evaluate(positions_[b]) / weight)};
+                }
+                if (!locked_[b]) {
+                    double cost = std::max(0.0, combined.evaluate(positions_[a]) / weight);
+                    if (best.cost < 0.0 || cost < best.cost) {
+                        best = {b, a, cost};
+                    }
+                }
+                collapses.push_back(best);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            collapseTo[i] = i;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t targetTriangles = targetIndexCount / 3;
+        size_t removed = 0;
+        size_t applied = 0;
+        bool errorReached = false;
+        for (const Collapse& collapse : collapses) {
+            if (triangleCount - removed <= targetTriangles) {
+                break;
+            }
+            if (collapse.cost > maxCost) {
+                errorReached = true;
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to] ||
+                !isValidCollapse(collapse.from, collapse.to, adjacencyOffsets, adjacency)) {
+                continue;
+            }
+
+            collapseTo[collapse.from] = collapse.to;
+            for (uint32_t j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1]; j++) {
+                const uint32_t* triangle = &indices_[adjacency[j] * 3];
+                bool sharesEdge = false;
+                for (int corner = 0; corner < 3; corner++) {
+                    touched[triangle[corner]] = 1;
+                    sharesEdge = sharesEdge || triangle[corner] == collapse.to;
+                }
+                removed += sharesEdge ? 1 : 0;
+            }
+            quadrics_[positionIds_[collapse.to]].add(quadrics_[positionIds_[collapse.from]]);
+            maxCost_ = std::max(maxCost_, collapse.cost);
+            applied++;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        // Move the collapsed corners and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i < indices_.size(); i += 3) {
+            uint32_t a = collapseTo[indices_[i]];
+            uint32_t b = collapseTo[indices_[i + 1]];
+            uint32_t c = collapseTo[indices_[i + 2]];
+            if (a != b && b != c && c != a) {
+                indices_[write++] = a;
+                indices_[write++] = b;
+                indices_[write++] = c;
+            }
+        }
+        indices_.resize(write);
+        if (errorReached) {
+            break;
+        }
+    }
+    return indices_;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,91 @@
+#include "VulkanEngine/ParallelRecorder.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+
+namespace VulkanEngine {
+
+ParallelRecorder::ParallelRecorder(VulkanDevice& device, JobSystem& jobSystem, uint32_t framesInFlight)
+    : device_(device.getDevice()), jobSystem_(jobSystem)
+{
+    // Transient: the buffers are re-recorded every frame
+    vk::CommandPoolCreateInfo poolInfo(vk::CommandPoolCreateFlagBits::eTransient,
+                                       device.getQueueFamilyIndices().graphicsFamily.value());
+    pools_.resize(framesInFlight);
+    for (auto& framePools : pools_) {
+        framePools.resize(jobSystem_.getThreadCount());
+        for (ThreadPool& threadPool : framePools) {
+            threadPool.pool = device_.createCommandPool(poolInfo);
+        }
+    }
+}
+
+ParallelRecorder::~ParallelRecorder() {
+    // Destroying a pool frees its command buffers
+    for (auto& framePools : pools_) {
+        for (ThreadPool& threadPool : framePools) {
+            device_.destroyCommandPool(threadPool.pool);
+        }
+    }
+}
+
+void ParallelRecorder::beginFrame(uint32_t frameIndex) {
+    frameIndex_ = frameIndex % static_cast<uint32_t>(pools_.size());
+    for (ThreadPool& threadPool : pools_[frameIndex_]) {
+        device_.resetCommandPool(threadPool.pool);
+        threadPool.used = 0;
+    }
+}
+
+std::vector<vk::CommandBuffer> ParallelRecorder::record(const vk::CommandBufferInheritanceInfo& inheritance, uint32_t itemCount,
+                                                        const RecordFunction& recordFunction) {
+    if (itemCount == 0) {
+        return {};
+    }
+
+    uint32_t taskCount = std::min(jobSystem_.getThreadCount(), (itemCount + MIN_ITEMS_PER_TASK - 1) / MIN_ITEMS_PER_TASK);
+    auto rangeBegin = [itemCount, taskCount](uint32_t task) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * task / taskCount);
+    };
+
+    std::vector<vk::CommandBuffer> secondaries(taskCount);
+    JobSystem::Counter counter;
+    for (uint32_t task = 1; task < taskCount; task++) {
+        jobSystem_.run([&, task] {
+            secondaries[task] = recordRange(inheritance, rangeBegin(task), rangeBegin(task + 1), recordFunction);
+        }, &counter);
+    }
+    std::exception_ptr error;
+    try {
+        secondaries[0] = recordRange(inheritance, rangeBegin(0), rangeBegin(1), recordFunction);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    jobSystem_.wait(counter); // The jobs reference locals, wait for them even on error
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return secondaries;
+}
+
+vk::CommandBuffer ParallelRecorder::recordRange(const vk::CommandBufferInheritanceInfo& inheritance, uint32_t begin, uint32_t end,
+                                                const RecordFunction& recordFunction) {
+    // A thread runs one job at a time, so nothing else touches its pool meanwhile
+    ThreadPool& threadPool = pools_[frameIndex_][JobSystem::getThreadIndex()];
+    if (threadPool.used == threadPool.buffers.size()) {
+        vk::CommandBufferAllocateInfo allocInfo(threadPool.pool, vk::CommandBufferLevel::eSecondary, 1);
+        threadPool.buffers.push_back(device_.allocateCommandBuffers(allocInfo)[0]);
+    }
+    vk::CommandBuffer commandBuffer = threadPool.buffers[threadPool.used++];
+
+    vk::CommandBufferBeginInfo beginInfo(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        &inheritance
+    );
+    commandBuffer.begin(beginInfo);
+    recordFunction(commandBuffer, begin, end);
+    commandBuffer.end();
+    return commandBuffer;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,138 @@
+#include "VulkanEngine/PipelineCache.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace VulkanEngine {
+
+namespace {
+
+// Layout of VkPipelineCacheHeaderVersionOne, read field by field to avoid alignment assumptions
+constexpr size_t HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+uint32_t readU32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+PipelineCache::PipelineCache(VulkanDevice& device, const std::string& path, AssetView seed)
+    : device_(device.getDevice()), properties_(device.getPhysicalDevice().getProperties()), path_(path)
+{
+    std::vector<char> fileData = loadFile();
+    if (fileData.empty() && !seed) {
+        std::cout << "No pipeline cache at '" << path_ << "', starting cold" << std::endl;
+    }
+
+    auto tryCreate = [this](const char* data, size_t size, const std::string& source) {
+        if (!isValid(data, size, source)) {
+            return false;
+        }
+        try {
+            cache_ = device_.createPipelineCache(vk::PipelineCacheCreateInfo({}, size, data));
+            loadedBytes_ = size;
+            return true;
+        } catch (const vk::SystemError& e) {
+            // The header matched but the driver still rejected the blob
+            std::cerr << "[WARN] " << source << " pipeline cache rejected by the driver: " << e.what() << std::endl;
+            return false;
+        }
+    };
+
+    // The on-disk cache has everything compiled since the seed was built. When it is
+    // rejected (e.g. written by an older driver) the bundled seed may still match.
+    bool loaded = !fileData.empty() && tryCreate(fileData.data(), fileData.size(), "On-disk");
+    if (!loaded && seed) {
+        loaded = tryCreate(static_cast<const char*>(seed.data), seed.size, "Bundled");
+    }
+    if (!loaded) {
+        cache_ = device_.createPipelineCache(vk::PipelineCacheCreateInfo());
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    if (cache_) {
+        device_.destroyPipelineCache(cache_);
+    }
+}
+
+std::vector<char> PipelineCache::loadFile() const {
+    std::ifstream file(path_, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<char> data(fileSize);
+    file.seekg(0);
+    file.read(data.data(), fileSize);
+    if (!file) {
+        std::cerr << "[WARN] Failed to read pipeline cache '" << path_ << "'" << std::endl;
+        return {};
+    }
+    return data;
+}
+
+bool PipelineCache::isValid(const char* data, size_t size, const std::string& source) const {
+    if (size < HEADER_SIZE) {
+        std::cerr << "[WARN] " << source << " pipeline cache is truncated, ignoring it" << std::endl;
+        return false;
+    }
+    uint32_t headerSize = readU32(data);
+    uint32_t headerVersion = readU32(data + 4);
+    uint32_t vendorID = readU32(data + 8);
+    uint32_t deviceID = readU32(data + 12);
+    const char* uuid = data + 16;
+
+    if (headerSize < HEADER_SIZE || headerSize > size ||
+        headerVersion != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne)) {
+        std::cerr << "[WARN] " << source << " pipeline cache has an unknown header, ignoring it" << std::endl;
+        return false;
+    }
+    if (vendorID != properties_.vendorID || deviceID != properties_.deviceID ||
+        std::memcmp(uuid, properties_.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0) {
+        // Normal after a GPU or driver change, not worth a warning
+        std::cout << source << " pipeline cache is from another device or driver, starting cold" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PipelineCache::save() const {
+    std::vector<uint8_t> data = device_.getPipelineCacheData(cache_);
+
+    std::string tempPath = path_ + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "[WARN] Failed to open '" << tempPath << "' for writing" << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.flush();
+        if (!file) {
+            std::cerr << "[WARN] Failed to write '" << tempPath << "'" << std::endl;
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    // Replaces the old file in one step
+    std::error_code error;
+    std::filesystem::rename(tempPath, path_, error);
+    if (error) {
+        std::cerr << "[WARN] Failed to replace pipeline cache '" << path_ << "': " << error.message() << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    std::cout << "Saved pipeline cache (" << data.size() << " bytes) to '" << path_ << "'" << std::endl;
+    return true;
+}
+
+} // namespace VulkanEngine
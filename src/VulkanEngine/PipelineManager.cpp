@@ -0,0 +1,373 @@
+#include "VulkanEngine/PipelineManager.h"
+#include "VulkanEngine/PipelineCache.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+bool PipelineKey::operator==(const PipelineKey& other) const {
+    return vertexShader == other.vertexShader && fragmentShader == other.fragmentShader &&
+           vertexLayout == other.vertexLayout && colorFormat == other.colorFormat &&
+           depthFormat == other.depthFormat && topology == other.topology && polygonMode == other.polygonMode &&
+           cullMode == other.cullMode && frontFace == other.frontFace && blend == other.blend &&
+           depthTest == other.depthTest && depthWrite == other.depthWrite && depthCompare == other.depthCompare;
+}
+
+size_t PipelineKeyHash::operator()(const PipelineKey& key) const {
+    // FNV-1a over the fields, padding never enters the hash
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(key.vertexShader);
+    mix(key.fragmentShader);
+    mix(key.vertexLayout);
+    mix(static_cast<uint64_t>(key.colorFormat));
+    mix(static_cast<uint64_t>(key.depthFormat));
+    mix(static_cast<uint64_t>(key.topology));
+    mix(static_cast<uint64_t>(key.polygonMode));
+    mix(static_cast<uint32_t>(key.cullMode));
+    mix(static_cast<uint64_t>(key.frontFace));
+    mix(static_cast<uint64_t>(key.blend));
+    mix((key.depthTest ? 1u : 0u) | (key.depthWrite ? 2u : 0u));
+    mix(static_cast<uint64_t>(key.depthCompare));
+    return static_cast<size_t>(hash);
+}
+
+PipelineManager::PipelineManager(VulkanDevice& device, JobSystem& jobSystem, PipelineCache& cache, vk::PipelineLayout layout)
+    : device_(device.getDevice()), jobSystem_(jobSystem), cache_(cache), layout_(layout),
+      dynamicRendering_(device.hasDynamicRendering())
+{
+}
+
+PipelineManager::~PipelineManager() {
+    // Compile jobs reference this
+    waitIdle();
+
+    for (auto& [key, entry] : entries_) {
+        if (entry.pipeline) {
+            device_.destroyPipeline(entry.pipeline);
+        }
+    }
+    for (Shader& shader : shaders_) {
+        device_.destroyShaderModule(shader.module);
+    }
+    for (auto& [formats, renderPass] : renderPasses_) {
+        device_.destroyRenderPass(renderPass);
+    }
+    for (vk::RenderPass renderPass : retiredRenderPasses_) {
+        device_.destroyRenderPass(renderPass);
+    }
+    for (vk::Pipeline pipeline : replacedPipelines_) {
+        device_.destroyPipeline(pipeline);
+    }
+    for (vk::Pipeline pipeline : computePipelines_) {
+        device_.destroyPipeline(pipeline);
+    }
+}
+
+std::vector<uint32_t> PipelineManager::readSpirv(const std::string& path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open shader: " + path);
+    }
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("Not a SPIR-V file: " + path);
+    }
+    std::vector<uint32_t> code(fileSize / sizeof(uint32_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(code.data()), fileSize);
+    return code;
+}
+
+PipelineManager::ShaderId PipelineManager::loadShader(const std::string& path, vk::ShaderStageFlagBits stage) {
+    std::vector<uint32_t> code = readSpirv(path);
+    return loadShader(path, code.data(), code.size() * sizeof(uint32_t), stage);
+}
+
+PipelineManager::ShaderId PipelineManager::loadShader(const std::string& name, const void* code, size_t size,
+                                                      vk::ShaderStageFlagBits stage) {
+    if (size == 0 || size % sizeof(uint32_t) != 0 || reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0) {
+        throw std::runtime_error("Not a SPIR-V blob: " + name);
+    }
+    vk::ShaderModule module = device_.createShaderModule(
+        vk::ShaderModuleCreateInfo({}, size, static_cast<const uint32_t*>(code)));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    shaders_.push_back({name, stage, module});
+    return static_cast<ShaderId>(shaders_.size() - 1);
+}
+
+void PipelineManager::reloadShader(ShaderId shader, const std::string& path) {
+    std::vector<uint32_t> code = readSpirv(path);
+    vk::ShaderModule module = device_.createShaderModule(vk::ShaderModuleCreateInfo({}, code));
+
+    // Running compiles may have copied the old module, let them finish before destroying it.
+    // Development only, so the stall is fine.
+    waitIdle();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shader >= shaders_.size()) {
+        device_.destroyShaderModule(module);
+        throw std::runtime_error("Unknown shader id " + std::to_string(shader));
+    }
+    // Pipelines keep their own copy of the code, only compiles need the module
+    device_.destroyShaderModule(shaders_[shader].module);
+    shaders_[shader].module = module;
+    shaders_[shader].path = path;
+
+    size_t recompiles = 0;
+    for (auto& [key, entry] : entries_) {
+        if (key.vertexShader != shader && key.fragmentShader != shader) {
+            continue;
+        }
+        if (entry.state == State::eReady) {
+            recompileAsync(key);
+        } else {
+            // Failed before, the new code may fix it
+            compileAsync(key);
+        }
+        recompiles++;
+    }
+    std::cout << "Reloaded " << path << ", recompiling " << recompiles << " pipelines" << std::endl;
+}
+
+std::vector<vk::Pipeline> PipelineManager::takeReplacedPipelines() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<vk::Pipeline> replaced;
+    replaced.swap(replacedPipelines_);
+    return replaced;
+}
+
+PipelineManager::VertexLayoutId PipelineManager::addVertexLayout(std::vector<vk::VertexInputBindingDescription> bindings,
+                                                                 std::vector<vk::VertexInputAttributeDescription> attributes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vertexLayouts_.push_back({std::move(bindings), std::move(attributes)});
+    return static_cast<VertexLayoutId>(vertexLayouts_.size() - 1);
+}
+
+void PipelineManager::addRenderPass(vk::Format colorFormat, vk::Format depthFormat, vk::RenderPass renderPass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vk::RenderPass& slot = renderPasses_[{colorFormat, depthFormat}];
+    if (slot && slot != renderPass) {
+        // Frames in flight may still use the old one. Pipelines built against it stay valid,
+        // render passes with equal formats are compatible.
+        retiredRenderPasses_.push_back(slot);
+    }
+    slot = renderPass;
+}
+
+vk::RenderPass PipelineManager::getRenderPass(vk::Format colorFormat, vk::Format depthFormat) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = renderPasses_.find({colorFormat, depthFormat});
+    return it != renderPasses_.end() ? it->second : nullptr;
+}
+
+vk::Pipeline PipelineManager::get(const PipelineKey& key, const PipelineKey& fallback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            compileAsync(key);
+        } else if (it->second.state == State::eReady) {
+            return it->second.pipeline;
+        }
+    }
+    return getBlocking(fallback);
+}
+
+vk::Pipeline PipelineManager::getBlocking(const PipelineKey& key) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        if (it->second.state == State::ePending) {
+            // A worker has it queued or compiling; wait for this key only, not every compile
+            compiled_.wait(lock, [&] { return entries_[key].state != State::ePending; });
+            it = entries_.find(key);
+        }
+        if (it->second.state == State::eFailed) {
+            throw std::runtime_error("Pipeline failed to compile earlier");
+        }
+        return it->second.pipeline;
+    }
+
+    entries_[key].state = State::ePending;
+    lock.unlock();
+    vk::Pipeline pipeline;
+    try {
+        pipeline = compile(key);
+    } catch (...) {
+        lock.lock();
+        entries_[key].state = State::eFailed;
+        compiled_.notify_all();
+        throw;
+    }
+    lock.lock();
+    entries_[key] = {State::eReady, pipeline};
+    compiled_.notify_all();
+    return pipeline;
+}
+
+void PipelineManager::request(const PipelineKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.find(key) == entries_.end()) {
+        compileAsync(key);
+    }
+}
+
+void PipelineManager::waitIdle() {
+    jobSystem_.wait(compiles_);
+}
+
+void PipelineManager::compileAsync(const PipelineKey& key) {
+    entries_[key].state = State::ePending;
+    jobSystem_.runBackground([this, key] {
+        Entry entry;
+        try {
+            entry.pipeline = compile(key);
+            entry.state = State::eReady;
+        } catch (const std::exception& e) {
+            // Callers keep getting the fallback
+            std::cerr << "[WARN] Background pipeline compile failed: " << e.what() << std::endl;
+            entry.state = State::eFailed;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key] = entry;
+        compiled_.notify_all();
+    }, &compiles_);
+}
+
+void PipelineManager::recompileAsync(const PipelineKey& key) {
+    jobSystem_.runBackground([this, key] {
+        vk::Pipeline pipeline;
+        try {
+            pipeline = compile(key);
+        } catch (const std::exception& e) {
+            // The old pipeline stays in use
+            std::cerr << "[WARN] Pipeline recompile failed: " << e.what() << std::endl;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[key];
+        if (entry.pipeline) {
+            replacedPipelines_.push_back(entry.pipeline);
+        }
+        entry = {State::eReady, pipeline};
+    }, &compiles_);
+}
+
+vk::Pipeline PipelineManager::compile(const PipelineKey& key) const {
+    // Copy what the compile needs, the containers can grow meanwhile
+    std::vector<vk::PipelineShaderStageCreateInfo> shaderStages;
+    VertexLayout vertexLayout;
+    vk::RenderPass renderPass = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (ShaderId id : {key.vertexShader, key.fragmentShader}) {
+            if (id >= shaders_.size()) {
+                throw std::runtime_error("Unknown shader id " + std::to_string(id));
+            }
+            shaderStages.emplace_back(vk::PipelineShaderStageCreateFlags{}, shaders_[id].stage, shaders_[id].module, "main");
+        }
+        if (key.vertexLayout >= vertexLayouts_.size()) {
+            throw std::runtime_error("Unknown vertex layout id " + std::to_string(key.vertexLayout));
+        }
+        vertexLayout = vertexLayouts_[key.vertexLayout];
+        if (!dynamicRendering_) {
+            auto it = renderPasses_.find({key.colorFormat, key.depthFormat});
+            if (it == renderPasses_.end()) {
+                throw std::runtime_error("No render pass for pipeline formats " + vk::to_string(key.colorFormat) + " / " +
+                                         vk::to_string(key.depthFormat));
+            }
+            renderPass = it->second;
+        }
+    }
+
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo({}, vertexLayout.bindings, vertexLayout.attributes);
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly({}, key.topology, VK_FALSE);
+
+    // Viewport and scissor are always dynamic, so resizes never touch pipelines
+    std::array<vk::DynamicState, 2> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    vk::PipelineDynamicStateCreateInfo dynamicStateInfo({}, dynamicStates);
+    vk::PipelineViewportStateCreateInfo viewportState({}, 1, nullptr, 1, nullptr);
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer(
+        {}, VK_FALSE, VK_FALSE, key.polygonMode, key.cullMode, key.frontFace, VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f);
+    vk::PipelineMultisampleStateCreateInfo multisampling({}, vk::SampleCountFlagBits::e1, VK_FALSE);
+
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment;
+    colorBlendAttachment.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+    if (key.blend != BlendMode::eOpaque) {
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+        colorBlendAttachment.dstColorBlendFactor =
+            key.blend == BlendMode::eAlpha ? vk::BlendFactor::eOneMinusSrcAlpha : vk::BlendFactor::eOne;
+        colorBlendAttachment.colorBlendOp = vk::BlendOp::eAdd;
+        colorBlendAttachment.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+        colorBlendAttachment.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+        colorBlendAttachment.alphaBlendOp = vk::BlendOp::eAdd;
+    }
+    vk::PipelineColorBlendStateCreateInfo colorBlending({}, VK_FALSE, vk::LogicOp::eCopy, 1, &colorBlendAttachment);
+
+    vk::PipelineDepthStencilStateCreateInfo depthStencil;
+    depthStencil.depthTestEnable = key.depthTest;
+    depthStencil.depthWriteEnable = key.depthWrite;
+    depthStencil.depthCompareOp = key.depthCompare;
+
+    vk::GraphicsPipelineCreateInfo pipelineInfo(
+        {}, shaderStages, &vertexInputInfo, &inputAssembly, nullptr, &viewportState, &rasterizer, &multisampling,
+        &depthStencil, &colorBlending, &dynamicStateInfo, layout_, renderPass, 0);
+
+    // Dynamic rendering: no render pass, the pipeline only needs the attachment formats
+    vk::PipelineRenderingCreateInfo renderingInfo(0, key.colorFormat, key.depthFormat);
+    if (dynamicRendering_) {
+        pipelineInfo.pNext = &renderingInfo;
+    }
+
+    auto result = device_.createGraphicsPipeline(cache_.get(), pipelineInfo);
+    if (result.result != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to create graphics pipeline! Error: " + vk::to_string(result.result));
+    }
+    return result.value;
+}
+
+vk::Pipeline PipelineManager::createComputePipeline(ShaderId shader, vk::PipelineLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shader >= shaders_.size() || shaders_[shader].stage != vk::ShaderStageFlagBits::eCompute) {
+        throw std::runtime_error("createComputePipeline: shader " + std::to_string(shader) + " is not a compute shader");
+    }
+    vk::PipelineShaderStageCreateInfo stage({}, vk::ShaderStageFlagBits::eCompute, shaders_[shader].module, "main");
+    auto result = device_.createComputePipeline(cache_.get(), vk::ComputePipelineCreateInfo({}, stage, layout));
+    if (result.result != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to create compute pipeline! Error: " + vk::to_string(result.result));
+    }
+    computePipelines_.push_back(result.value);
+    return result.value;
+}
+
+size_t PipelineManager::getPipelineCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, entry] : entries_) {
+        count += entry.state == State::eReady ? 1 : 0;
+    }
+    return count;
+}
+
+size_t PipelineManager::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, entry] : entries_) {
+        count += entry.state == State::ePending ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,534 @@
+#include "VulkanEngine/RenderGraph.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Only writes have to be made available, reads just need the execution dependency
+static vk::AccessFlags writeAccessMask(vk::AccessFlags access) {
+    return access & (vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+                     vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite |
+                     vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eMemoryWrite);
+}
+
+// --- PassBuilder ---
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(ResourceHandle resource, ResourceUsage usage) {
+    graph_.passes_[pass_].resources.push_back({resource, usage, false});
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(ResourceHandle resource, ResourceUsage usage) {
+    graph_.passes_[pass_].resources.push_back({resource, usage, true});
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::sideEffects() {
+    graph_.passes_[pass_].sideEffects = true;
+    return *this;
+}
+
+// --- RenderGraph ---
+
+RenderGraph::RenderGraph(VulkanDevice& device, MemoryAllocator& allocator)
+    : device_(device.getDevice()), allocator_(allocator)
+{
+}
+
+RenderGraph::~RenderGraph() {
+    for (Resource& resource : resources_) {
+        if (resource.imported) {
+            continue;
+        }
+        if (resource.view) {
+            device_.destroyImageView(resource.view);
+        }
+        if (resource.image) {
+            device_.destroyImage(resource.image);
+        }
+        if (resource.buffer) {
+            device_.destroyBuffer(resource.buffer);
+        }
+    }
+    for (AliasGroup& group : aliasGroups_) {
+        allocator_.free(group.allocation);
+    }
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(const std::string& name, const ImageDesc& desc,
+                                                     const ResourceState& initialState, const ResourceState& finalState) {
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.imported = true;
+    resource.imageDesc = desc;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    resources_.push_back(resource);
+    return static_cast<ResourceHandle>(resources_.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importBuffer(const std::string& name, vk::Buffer buffer, const BufferDesc& desc,
+                                                      const ResourceState& initialState, const ResourceState& finalState) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.bufferDesc = desc;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    resource.buffer = buffer;
+    resources_.push_back(resource);
+    return static_cast<ResourceHandle>(resources_.size() - 1);
+}
+
+void RenderGraph::setImportedImage(ResourceHandle resource, vk::Image image, vk::ImageView view) {
+    resources_[resource].image = image;
+    resources_[resource].view = view;
+}
+
+void RenderGraph::setImportedBuffer(ResourceHandle resource, vk::Buffer buffer) {
+    resources_[resource].buffer = buffer;
+}
+
+RenderGraph::ResourceHandle RenderGraph::createImage(const std::string& name, const ImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.imageDesc = desc;
+    resources_.push_back(resource);
+    return static_cast<ResourceHandle>(resources_.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::createBuffer(const std::string& name, const BufferDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.bufferDesc = desc;
+    resources_.push_back(resource);
+    return static_cast<ResourceHandle>(resources_.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name, PassType type, ExecuteCallback execute) {
+    if (compiled_) {
+        throw std::runtime_error("RenderGraph: cannot add pass '" + name + "' after compile()");
+    }
+    Pass pass;
+    pass.name = name;
+    pass.type = type;
+    pass.execute = std::move(execute);
+    passes_.push_back(std::move(pass));
+    return PassBuilder(*this, static_cast<uint32_t>(passes_.size() - 1));
+}
+
+RenderGraph::UsageInfo RenderGraph::getUsageInfo(ResourceUsage usage, PassType type) {
+    vk::PipelineStageFlags shaderStages;
+    switch (type) {
+        case PassType::eGraphics:
+            shaderStages = vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+            break;
+        case PassType::eCompute:
+            shaderStages = vk::PipelineStageFlagBits::eComputeShader;
+            break;
+        case PassType::eTransfer:
+            shaderStages = vk::PipelineStageFlagBits::eTransfer;
+            break;
+    }
+    const vk::PipelineStageFlags depthStages =
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+
+    switch (usage) {
+        case ResourceUsage::eColorAttachment:
+            return {vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+                    vk::ImageLayout::eColorAttachmentOptimal};
+        case ResourceUsage::eDepthAttachment:
+            return {depthStages,
+                    vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                    vk::ImageLayout::eDepthStencilAttachmentOptimal};
+        case ResourceUsage::eDepthRead:
+            return {depthStages, vk::AccessFlagBits::eDepthStencilAttachmentRead, vk::ImageLayout::eDepthStencilReadOnlyOptimal};
+        case ResourceUsage::eSampled:
+            return {shaderStages, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal};
+        case ResourceUsage::eStorageRead:
+            return {shaderStages, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eGeneral};
+        case ResourceUsage::eStorageWrite:
+            return {shaderStages, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite, vk::ImageLayout::eGeneral};
+        case ResourceUsage::eUniform:
+            return {shaderStages, vk::AccessFlagBits::eUniformRead, vk::ImageLayout::eUndefined};
+        case ResourceUsage::eVertexBuffer:
+            return {vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eVertexAttributeRead, vk::ImageLayout::eUndefined};
+        case ResourceUsage::eIndexBuffer:
+            return {vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eIndexRead, vk::ImageLayout::eUndefined};
+        case ResourceUsage::eIndirect:
+            return {vk::PipelineStageFlagBits::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead, vk::ImageLayout::eUndefined};
+        case ResourceUsage::eTransferSrc:
+            return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eTransferSrcOptimal};
+        case ResourceUsage::eTransferDst:
+            return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eTransferDstOptimal};
+    }
+    throw std::runtime_error("RenderGraph: unknown resource usage");
+}
+
+void RenderGraph::compile() {
+    if (compiled_) {
+        throw std::runtime_error("RenderGraph: compile() called twice");
+    }
+
+    std::vector<bool> live(passes_.size(), false);
+    cullPasses(live);
+    for (uint32_t i = 0; i < passes_.size(); i++) {
+        if (live[i]) {
+            executionOrder_.push_back(i);
+        } else {
+            stats_.culledPassCount++;
+        }
+    }
+    stats_.passCount = static_cast<uint32_t>(executionOrder_.size());
+
+    // Lifetimes in terms of execution order, used for aliasing
+    for (uint32_t order = 0; order < executionOrder_.size(); order++) {
+        for (const PassResource& passResource : passes_[executionOrder_[order]].resources) {
+            Resource& resource = resources_[passResource.resource];
+            resource.firstPass = std::min(resource.firstPass, order);
+            resource.lastPass = std::max(resource.lastPass, order);
+        }
+    }
+
+    allocateTransients();
+    buildBarriers();
+    compiled_ = true;
+}
+
+void RenderGraph::cullPasses(std::vector<bool>& live) const {
+    // Imported resources leave the graph, so whatever writes them matters.
+    // From there, walk back through everything the live passes read.
+    std::vector<bool> needed(resources_.size(), false);
+    for (size_t i = 0; i < resources_.size(); i++) {
+        needed[i] = resources_[i].imported;
+    }
+    for (size_t i = 0; i < passes_.size(); i++) {
+        live[i] = passes_[i].sideEffects;
+    }
+
+    std::vector<bool> processed(passes_.size(), false);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = passes_.size(); i-- > 0;) {
+            if (!live[i]) {
+                for (const PassResource& passResource : passes_[i].resources) {
+                    if (passResource.write && needed[passResource.resource]) {
+                        live[i] = true;
+                        break;
+                    }
+                }
+            }
+            if (live[i] && !processed[i]) {
+                processed[i] = true;
+                changed = true;
+                for (const PassResource& passResource : passes_[i].resources) {
+                    if (!passResource.write) {
+                        needed[passResource.resource] = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void RenderGraph::allocateTransients() {
+    std::vector<ResourceHandle> transients;
+    for (ResourceHandle handle = 0; handle < resources_.size(); handle++) {
+        Resource& resource = resources_[handle];
+        // Unused transients (only touched by culled passes) are never created
+        if (resource.imported || resource.firstPass == ~0u) {
+            continue;
+        }
+
+        if (resource.isImage) {
+            const ImageDesc& desc = resource.imageDesc;
+            vk::ImageCreateInfo imageInfo(
+                {}, vk::ImageType::e2D, desc.format, vk::Extent3D{desc.extent.width, desc.extent.height, 1},
+                1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, desc.usage,
+                vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::eUndefined
+            );
+            resource.image = device_.createImage(imageInfo);
+            resource.requirements = device_.getImageMemoryRequirements(resource.image);
+        } else {
+            vk::BufferCreateInfo bufferInfo({}, resource.bufferDesc.size, resource.bufferDesc.usage, vk::SharingMode::eExclusive);
+            resource.buffer = device_.createBuffer(bufferInfo);
+            resource.requirements = device_.getBufferMemoryRequirements(resource.buffer);
+        }
+        stats_.unaliasedBytes += resource.requirements.size;
+        transients.push_back(handle);
+    }
+
+    // Biggest first, each one goes to the lowest offset that does not collide with a
+    // resource that is alive at the same time
+    std::stable_sort(transients.begin(), transients.end(), [this](ResourceHandle a, ResourceHandle b) {
+        return resources_[a].requirements.size > resources_[b].requirements.size;
+    });
+
+    for (ResourceHandle handle : transients) {
+        Resource& resource = resources_[handle];
+
+        uint32_t groupIndex = ~0u;
+        for (uint32_t i = 0; i < aliasGroups_.size(); i++) {
+            if (aliasGroups_[i].isImage == resource.isImage &&
+                (aliasGroups_[i].memoryTypeBits & resource.requirements.memoryTypeBits) != 0) {
+                groupIndex = i;
+                break;
+            }
+        }
+        if (groupIndex == ~0u) {
+            AliasGroup group;
+            group.isImage = resource.isImage;
+            group.memoryTypeBits = resource.requirements.memoryTypeBits;
+            aliasGroups_.push_back(group);
+            groupIndex = static_cast<uint32_t>(aliasGroups_.size() - 1);
+        }
+        AliasGroup& group = aliasGroups_[groupIndex];
+
+        std::vector<vk::DeviceSize> candidates = {0};
+        for (ResourceHandle placedHandle : group.resources) {
+            const Resource& placed = resources_[placedHandle];
+            candidates.push_back(alignUp(placed.memoryOffset + placed.requirements.size, resource.requirements.alignment));
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        vk::DeviceSize offset = 0;
+        for (vk::DeviceSize candidate : candidates) {
+            bool collides = false;
+            for (ResourceHandle placedHandle : group.resources) {
+                const Resource& placed = resources_[placedHandle];
+                bool lifetimesOverlap = !(placed.lastPass < resource.firstPass || resource.lastPass < placed.firstPass);
+                bool memoryOverlaps = candidate < placed.memoryOffset + placed.requirements.size &&
+                                      placed.memoryOffset < candidate + resource.requirements.size;
+                if (lifetimesOverlap && memoryOverlaps) {
+                    collides = true;
+                    break;
+                }
+            }
+            if (!collides) {
+                offset = candidate;
+                break;
+            }
+        }
+
+        resource.memoryOffset = offset;
+        resource.aliasGroup = groupIndex;
+        group.memoryTypeBits &= resource.requirements.memoryTypeBits;
+        group.alignment = std::max(group.alignment, resource.requirements.alignment);
+        group.size = std::max(group.size, offset + resource.requirements.size);
+        group.resources.push_back(handle);
+    }
+
+    for (AliasGroup& group : aliasGroups_) {
+        vk::MemoryRequirements requirements(group.size, group.alignment, group.memoryTypeBits);
+        group.allocation = allocator_.allocate(requirements, vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                               group.isImage ? ResourceKind::eImage : ResourceKind::eBuffer);
+        stats_.transientBytes += group.size;
+
+        for (ResourceHandle handle : group.resources) {
+            Resource& resource = resources_[handle];
+            vk::DeviceSize memoryOffset = group.allocation.offset + resource.memoryOffset;
+            if (resource.isImage) {
+                device_.bindImageMemory(resource.image, group.allocation.memory, memoryOffset);
+                vk::ImageViewCreateInfo viewInfo(
+                    {}, resource.image, vk::ImageViewType::e2D, resource.imageDesc.format, {},
+                    vk::ImageSubresourceRange(resource.imageDesc.aspect, 0, 1, 0, 1)
+                );
+                resource.view = device_.createImageView(viewInfo);
+            } else {
+                device_.bindBufferMemory(resource.buffer, group.allocation.memory, memoryOffset);
+            }
+        }
+    }
+}
+
+void RenderGraph::buildBarriers() {
+    struct State {
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags writeStage;  // Last write or layout transition
+        vk::AccessFlags writeAccess;
+        vk::PipelineStageFlags readStages;  // Reads since then, for write-after-read
+        vk::PipelineStageFlags visibleStages; // Where the last write is already visible
+        vk::AccessFlags visibleAccess;
+        bool pendingWrite = false;
+        bool firstUse = false;
+    };
+
+    // Every stage and write a resource is touched with, for hazards across aliases
+    std::vector<vk::PipelineStageFlags> usedStages(resources_.size());
+    std::vector<vk::AccessFlags> usedWrites(resources_.size());
+    for (uint32_t passIndex : executionOrder_) {
+        const Pass& pass = passes_[passIndex];
+        for (const PassResource& passResource : pass.resources) {
+            UsageInfo info = getUsageInfo(passResource.usage, pass.type);
+            usedStages[passResource.resource] |= info.stage;
+            usedWrites[passResource.resource] |= writeAccessMask(info.access);
+        }
+    }
+
+    std::vector<State> states(resources_.size());
+    for (ResourceHandle handle = 0; handle < resources_.size(); handle++) {
+        const Resource& resource = resources_[handle];
+        State& state = states[handle];
+        if (resource.imported) {
+            state.layout = resource.initialState.layout;
+            state.writeStage = resource.initialState.stage;
+            state.writeAccess = resource.initialState.access;
+            state.pendingWrite = static_cast<bool>(resource.initialState.access);
+            continue;
+        }
+        if (resource.aliasGroup == ~0u) {
+            continue;
+        }
+
+        // A transient's first use has to wait for everything that used the same bytes before it:
+        // aliased resources earlier in the frame, and its own uses in the previous frame
+        state.firstUse = true;
+        for (ResourceHandle otherHandle : aliasGroups_[resource.aliasGroup].resources) {
+            const Resource& other = resources_[otherHandle];
+            bool memoryOverlaps = resource.memoryOffset < other.memoryOffset + other.requirements.size &&
+                                  other.memoryOffset < resource.memoryOffset + resource.requirements.size;
+            if (memoryOverlaps) {
+                state.writeStage |= usedStages[otherHandle];
+                state.writeAccess |= usedWrites[otherHandle];
+            }
+        }
+    }
+
+    passBarriers_.resize(executionOrder_.size());
+    for (uint32_t order = 0; order < executionOrder_.size(); order++) {
+        const Pass& pass = passes_[executionOrder_[order]];
+        std::vector<Barrier>& barriers = passBarriers_[order];
+
+        for (const PassResource& passResource : pass.resources) {
+            const Resource& resource = resources_[passResource.resource];
+            State& state = states[passResource.resource];
+            UsageInfo info = getUsageInfo(passResource.usage, pass.type);
+            vk::ImageLayout newLayout = resource.isImage ? info.layout : vk::ImageLayout::eUndefined;
+            bool layoutChange = resource.isImage && state.layout != newLayout;
+
+            if (passResource.write || layoutChange || state.firstUse) {
+                vk::PipelineStageFlags srcStage = state.writeStage | state.readStages;
+                if (!srcStage) {
+                    srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
+                }
+                barriers.push_back({passResource.resource, srcStage, info.stage, state.writeAccess, info.access,
+                                    state.layout, newLayout});
+                state.layout = newLayout;
+                state.firstUse = false;
+
+                if (passResource.write) {
+                    state.writeStage = info.stage;
+                    state.writeAccess = writeAccessMask(info.access);
+                    state.readStages = {};
+                    state.visibleStages = {};
+                    state.visibleAccess = {};
+                } else {
+                    // The transition is the new "write"; later readers chain off this stage
+                    state.writeStage = info.stage;
+                    state.writeAccess = {};
+                    state.readStages = info.stage;
+                    state.visibleStages = info.stage;
+                    state.visibleAccess = info.access;
+                }
+                state.pendingWrite = true;
+            } else {
+                // Read-after-read needs nothing; read-after-write only if the write is not visible here yet
+                if (state.pendingWrite &&
+                    ((state.visibleStages & info.stage) != info.stage || (state.visibleAccess & info.access) != info.access)) {
+                    barriers.push_back({passResource.resource, state.writeStage, info.stage, state.writeAccess, info.access,
+                                        state.layout, state.layout});
+                    state.visibleStages |= info.stage;
+                    state.visibleAccess |= info.access;
+                }
+                state.readStages |= info.stage;
+            }
+        }
+
+        stats_.barrierCount += static_cast<uint32_t>(barriers.size());
+        stats_.barrierBatchCount += barriers.empty() ? 0 : 1;
+    }
+
+    // Hand imported resources back the way the outside world expects them
+    for (ResourceHandle handle = 0; handle < resources_.size(); handle++) {
+        const Resource& resource = resources_[handle];
+        if (!resource.imported) {
+            continue;
+        }
+        const State& state = states[handle];
+        const ResourceState& finalState = resource.finalState;
+        bool layoutChange = resource.isImage && finalState.layout != vk::ImageLayout::eUndefined && state.layout != finalState.layout;
+        bool flush = state.writeAccess && finalState.access;
+        if (!layoutChange && !flush) {
+            continue;
+        }
+
+        vk::PipelineStageFlags srcStage = state.writeStage | state.readStages;
+        if (!srcStage) {
+            srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
+        }
+        finalBarriers_.push_back({handle, srcStage, finalState.stage, state.writeAccess, finalState.access,
+                                  state.layout, layoutChange ? finalState.layout : state.layout});
+    }
+    stats_.barrierCount += static_cast<uint32_t>(finalBarriers_.size());
+    stats_.barrierBatchCount += finalBarriers_.empty() ? 0 : 1;
+}
+
+void RenderGraph::execute(vk::CommandBuffer commandBuffer) {
+    if (!compiled_) {
+        throw std::runtime_error("RenderGraph: execute() called before compile()");
+    }
+
+    for (uint32_t order = 0; order < executionOrder_.size(); order++) {
+        recordBarriers(commandBuffer, passBarriers_[order]);
+        passes_[executionOrder_[order]].execute(commandBuffer);
+    }
+    recordBarriers(commandBuffer, finalBarriers_);
+}
+
+void RenderGraph::recordBarriers(vk::CommandBuffer commandBuffer, const std::vector<Barrier>& barriers) const {
+    if (barriers.empty()) {
+        return;
+    }
+
+    // One call per batch; the stage masks are merged
+    vk::PipelineStageFlags srcStage;
+    vk::PipelineStageFlags dstStage;
+    std::vector<vk::ImageMemoryBarrier> imageBarriers;
+    std::vector<vk::BufferMemoryBarrier> bufferBarriers;
+    for (const Barrier& barrier : barriers) {
+        const Resource& resource = resources_[barrier.resource];
+        srcStage |= barrier.srcStage;
+        dstStage |= barrier.dstStage;
+        if (resource.isImage) {
+            imageBarriers.emplace_back(
+                barrier.srcAccess, barrier.dstAccess, barrier.oldLayout, barrier.newLayout,
+                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, resource.image,
+                vk::ImageSubresourceRange(resource.imageDesc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS)
+            );
+        } else {
+            bufferBarriers.emplace_back(
+                barrier.srcAccess, barrier.dstAccess, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                resource.buffer, 0, VK_WHOLE_SIZE
+            );
+        }
+    }
+    commandBuffer.pipelineBarrier(srcStage, dstStage, {}, nullptr, bufferBarriers, imageBarriers);
+}
+
+void RenderGraph::printStats(std::ostream& out) const {
+    out << "Render graph: " << stats_.passCount << " passes (" << stats_.culledPassCount << " culled), "
+        << stats_.barrierCount << " barriers in " << stats_.barrierBatchCount << " batches, transient memory "
+        << stats_.transientBytes / 1024 << " KiB (" << stats_.unaliasedBytes / 1024 << " KiB without aliasing)" << std::endl;
+}
+
+} // namespace VulkanEngine
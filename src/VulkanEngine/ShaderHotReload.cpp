@@ -0,0 +1,167 @@
+#include "VulkanEngine/ShaderHotReload.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanEngine {
+
+namespace {
+
+constexpr std::chrono::milliseconds WATCH_INTERVAL{100};
+constexpr std::chrono::milliseconds POLL_INTERVAL{250};
+
+} // namespace
+
+ShaderHotReload::ShaderHotReload(const std::string& sourceDir, const std::string& glslc)
+    : sourceDir_(sourceDir), glslc_(glslc)
+{
+    watcher_ = std::thread(&ShaderHotReload::watchLoop, this);
+    std::cout << "Shader hot reload: watching " << sourceDir_ << ", compiling with " << glslc_ << std::endl;
+}
+
+ShaderHotReload::~ShaderHotReload() {
+    // Finishes a compile that is running first
+    stopping_ = true;
+    watcher_.join();
+}
+
+void ShaderHotReload::watch(const std::string& sourceFile, const std::string& spirvPath, PipelineManager::ShaderId shader) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    watched_[sourceFile].push_back({spirvPath, shader});
+}
+
+std::vector<ShaderHotReload::Reload> ShaderHotReload::poll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Reload> finished;
+    finished.swap(finished_);
+    return finished;
+}
+
+void ShaderHotReload::compileSettled() {
+    std::vector<std::pair<std::string, std::vector<Watched>>> toCompile;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::time_point now = Clock::now();
+        for (auto it = changed_.begin(); it != changed_.end();) {
+            if (now - it->second < SETTLE_TIME) {
+                ++it;
+                continue;
+            }
+            toCompile.emplace_back(it->first, watched_[it->first]);
+            it = changed_.erase(it);
+        }
+    }
+
+    // glslc runs as a separate process. Changes made meanwhile are queued by the next pass
+    // of the watch loop and compiled after this.
+    for (auto& [sourceFile, targets] : toCompile) {
+        std::vector<Reload> reloads;
+        for (const Watched& target : targets) {
+            if (compile(sourceFile, target.spirvPath)) {
+                reloads.push_back({target.shader, target.spirvPath});
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.insert(finished_.end(), reloads.begin(), reloads.end());
+    }
+}
+
+bool ShaderHotReload::compile(const std::string& sourceFile, const std::string& spirvPath) const {
+    // Written next to the target and renamed over it, the loader never sees half a file
+    std::string sourcePath = (std::filesystem::path(sourceDir_) / sourceFile).string();
+    std::string tempPath = spirvPath + ".tmp";
+    std::string command = "\"" + glslc_ + "\" \"" + sourcePath + "\" -o \"" + tempPath + "\"";
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes of the whole line
+    command = "\"" + command + "\"";
+#endif
+
+    std::cout << "Compiling " << sourcePath << std::endl;
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "[WARN] Failed to compile " << sourcePath << ", keeping the previous version" << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, spirvPath, error);
+    if (error) {
+        std::cerr << "[WARN] Failed to replace " << spirvPath << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShaderHotReload::markChanged(const std::string& sourceFile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (watched_.count(sourceFile) > 0) {
+        changed_[sourceFile] = Clock::now();
+    }
+}
+
+void ShaderHotReload::watchLoop() {
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors often save by writing a new file and renaming it over the old one, so watch
+    // the directory rather than the files
+    if (fd >= 0 && inotify_add_watch(fd, sourceDir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        pollfd pollFd{fd, POLLIN, 0};
+        while (!stopping_) {
+            if (::poll(&pollFd, 1, static_cast<int>(WATCH_INTERVAL.count())) > 0) {
+                ssize_t length;
+                while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* event = buffer; event < buffer + length;) {
+                        const inotify_event* info = reinterpret_cast<const inotify_event*>(event);
+                        if (info->len > 0) {
+                            markChanged(info->name);
+                        }
+                        event += sizeof(inotify_event) + info->len;
+                    }
+                }
+            }
+            compileSettled();
+        }
+        close(fd);
+        return;
+    }
+    std::cerr << "[WARN] inotify unavailable for " << sourceDir_ << ", polling for shader changes" << std::endl;
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+
+    // Portable fallback: compare modification times
+    std::map<std::string, std::filesystem::file_time_type> lastWrite;
+    while (!stopping_) {
+        std::vector<std::string> sources;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [sourceFile, targets] : watched_) {
+                sources.push_back(sourceFile);
+            }
+        }
+        for (const std::string& sourceFile : sources) {
+            std::error_code error;
+            auto writeTime = std::filesystem::last_write_time(std::filesystem::path(sourceDir_) / sourceFile, error);
+            if (error) {
+                continue;
+            }
+            auto it = lastWrite.find(sourceFile);
+            if (it != lastWrite.end() && it->second != writeTime) {
+                markChanged(sourceFile);
+            }
+            lastWrite[sourceFile] = writeTime;
+        }
+        compileSettled();
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+}
+
+} // namespace VulkanEngine
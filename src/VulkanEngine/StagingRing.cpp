@@ -0,0 +1,96 @@
+#include "VulkanEngine/StagingRing.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <stdexcept>
+#include <string>
+#include <cstring> // For memcpy
+
+namespace VulkanEngine {
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+StagingRing::StagingRing(VulkanDevice& device, MemoryAllocator& allocator, vk::DeviceSize size)
+    : vulkanDevice_(device), allocator_(allocator), device_(device.getDevice()),
+      size_(alignUp(size, MAX_ALIGNMENT))
+{
+    vk::BufferCreateInfo bufferInfo({}, size_, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive);
+    buffer_ = device_.createBuffer(bufferInfo);
+    allocation_ = allocator_.allocateBuffer(buffer_,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+StagingRing::~StagingRing() {
+    // The owner has waited for the device, so no copy reads the ring anymore
+    device_.destroyBuffer(buffer_);
+    allocator_.free(allocation_);
+}
+
+StagingRing::Region StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+    if (alignment == 0 || alignment > MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        throw std::runtime_error("StagingRing: alignment must be a power of two up to " + std::to_string(MAX_ALIGNMENT));
+    }
+    if (size > size_) {
+        throw std::runtime_error("StagingRing: upload of " + std::to_string(size) + " bytes does not fit in the ring");
+    }
+
+    reclaim();
+    for (;;) {
+        uint64_t start = alignUp(head_, alignment);
+        // Spans never wrap; skip to the start of the next lap instead
+        if (start % size_ + size > size_) {
+            start = (start / size_ + 1) * size_;
+        }
+
+        if (start + size - tail_ <= size_) {
+            head_ = start + size;
+
+            Region region;
+            region.buffer = buffer_;
+            region.offset = start % size_;
+            region.size = size;
+            region.data = static_cast<char*>(allocation_.mappedData) + region.offset;
+            return region;
+        }
+
+        if (inFlight_.empty()) {
+            // Only unsubmitted uploads are left in the way, waiting would never finish
+            throw std::runtime_error("StagingRing: ring is full of uploads that were never submitted");
+        }
+        vk::SemaphoreWaitInfo waitInfo({}, 1, &inFlight_.front().timeline, &inFlight_.front().value);
+        (void)device_.waitSemaphores(waitInfo, UINT64_MAX);
+        reclaim();
+    }
+}
+
+StagingRing::Region StagingRing::upload(const void* data, vk::DeviceSize size, vk::DeviceSize alignment) {
+    Region region = allocate(size, alignment);
+    memcpy(region.data, data, static_cast<size_t>(size));
+    return region;
+}
+
+void StagingRing::recordCopyToBuffer(vk::CommandBuffer commandBuffer, const Region& region, vk::Buffer dstBuffer, vk::DeviceSize dstOffset) {
+    vk::BufferCopy copyRegion(region.offset, dstOffset, region.size);
+    commandBuffer.copyBuffer(region.buffer, dstBuffer, copyRegion);
+}
+
+void StagingRing::recordCopyToImage(vk::CommandBuffer commandBuffer, const Region& region, vk::Image dstImage,
+                                    vk::ImageLayout dstLayout, vk::BufferImageCopy copy) {
+    copy.bufferOffset += region.offset;
+    commandBuffer.copyBufferToImage(region.buffer, dstImage, dstLayout, copy);
+}
+
+void StagingRing::closeSubmission(vk::Semaphore timeline, uint64_t value) {
+    inFlight_.push_back({timeline, value, head_});
+}
+
+void StagingRing::reclaim() {
+    while (!inFlight_.empty() &&
+           device_.getSemaphoreCounterValue(inFlight_.front().timeline) >= inFlight_.front().value) {
+        tail_ = inFlight_.front().end;
+        inFlight_.pop_front();
+    }
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,271 @@
+#include "VulkanEngine/TlsfAllocator.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace VulkanEngine {
+
+// Bit scan helpers (v must be non-zero)
+static uint32_t findLastSet(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(v));
+#endif
+}
+
+static uint32_t findFirstSet(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(v));
+#endif
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// All offsets and sizes are kept at multiples of this, so first-level 0 maps exactly
+static constexpr uint64_t MIN_ALIGNMENT = 8;
+
+TlsfAllocator::TlsfAllocator(uint64_t size)
+    : size_(size & ~(MIN_ALIGNMENT - 1))
+{
+    for (auto& level : freeHeads_) {
+        level.fill(INVALID_NODE);
+    }
+
+    uint32_t root = newNode();
+    nodes_[root].offset = 0;
+    nodes_[root].size = size_;
+    nodes_[root].isFree = true;
+    insertFree(root);
+}
+
+uint32_t TlsfAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset) {
+    size = alignUp(std::max<uint64_t>(size, 1), MIN_ALIGNMENT);
+    alignment = std::max(alignment, MIN_ALIGNMENT);
+
+    // Offsets are multiples of MIN_ALIGNMENT, so this is the worst-case padding
+    uint64_t searchSize = size + (alignment - MIN_ALIGNMENT);
+    if (size > size_) {
+        return INVALID_NODE;
+    }
+
+    uint32_t fl, sl;
+    uint32_t node = INVALID_NODE;
+    mappingSearch(searchSize, fl, sl);
+    if (fl < FL_INDEX_COUNT) {
+        node = findFreeNode(fl, sl);
+    }
+    if (node == INVALID_NODE) {
+        // The rounded-up search skips the request's own size class; walk that list before giving up
+        node = findFreeNodeInClass(size, alignment);
+        if (node == INVALID_NODE) {
+            return INVALID_NODE;
+        }
+    }
+    removeFree(node);
+
+    uint64_t padding = alignUp(nodes_[node].offset, alignment) - nodes_[node].offset;
+    if (padding > 0) {
+        // Hand the padding to the previous free neighbour, or make it a free node of its own
+        uint32_t prev = nodes_[node].prevPhysical;
+        if (prev != INVALID_NODE && nodes_[prev].isFree) {
+            removeFree(prev);
+            nodes_[prev].size += padding;
+            insertFree(prev);
+        } else {
+            uint32_t pad = newNode();
+            nodes_[pad].offset = nodes_[node].offset;
+            nodes_[pad].size = padding;
+            nodes_[pad].isFree = true;
+            nodes_[pad].prevPhysical = prev;
+            nodes_[pad].nextPhysical = node;
+            if (prev != INVALID_NODE) {
+                nodes_[prev].nextPhysical = pad;
+            }
+            nodes_[node].prevPhysical = pad;
+            insertFree(pad);
+        }
+        nodes_[node].offset += padding;
+        nodes_[node].size -= padding;
+    }
+
+    if (nodes_[node].size - size >= MIN_SPLIT_SIZE) {
+        splitTail(node, size);
+    }
+
+    nodes_[node].isFree = false;
+    usedBytes_ += nodes_[node].size;
+    allocationCount_++;
+
+    outOffset = nodes_[node].offset;
+    return node;
+}
+
+void TlsfAllocator::free(uint32_t node) {
+    if (node == INVALID_NODE || nodes_[node].isFree) {
+        return;
+    }
+
+    nodes_[node].isFree = true;
+    usedBytes_ -= nodes_[node].size;
+    allocationCount_--;
+
+    uint32_t next = nodes_[node].nextPhysical;
+    if (next != INVALID_NODE && nodes_[next].isFree) {
+        removeFree(next);
+        mergeWithNext(node);
+    }
+    uint32_t prev = nodes_[node].prevPhysical;
+    if (prev != INVALID_NODE && nodes_[prev].isFree) {
+        removeFree(prev);
+        mergeWithNext(prev);
+        node = prev;
+    }
+    insertFree(node);
+}
+
+// --- Size class mapping ---
+
+void TlsfAllocator::mappingInsert(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        fl = 0;
+        sl = static_cast<uint32_t>(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+        uint32_t msb = findLastSet(size);
+        sl = static_cast<uint32_t>(size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        fl = msb - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+void TlsfAllocator::mappingSearch(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    // Round up to the next size class so any node found there is large enough
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += (1ull << (findLastSet(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mappingInsert(size, fl, sl);
+}
+
+uint32_t TlsfAllocator::findFreeNode(uint32_t& fl, uint32_t& sl) const {
+    uint32_t slMap = slBitmaps_[fl] & (~0u << sl);
+    if (slMap == 0) {
+        if (fl + 1 >= FL_INDEX_COUNT) {
+            return INVALID_NODE;
+        }
+        uint64_t flMap = flBitmap_ & (~0ull << (fl + 1));
+        if (flMap == 0) {
+            return INVALID_NODE;
+        }
+        fl = findFirstSet(flMap);
+        slMap = slBitmaps_[fl];
+    }
+    sl = findFirstSet(slMap);
+    return freeHeads_[fl][sl];
+}
+
+uint32_t TlsfAllocator::findFreeNodeInClass(uint64_t size, uint64_t alignment) const {
+    uint32_t fl, sl;
+    mappingInsert(size, fl, sl);
+    for (uint32_t node = freeHeads_[fl][sl]; node != INVALID_NODE; node = nodes_[node].nextFree) {
+        uint64_t padding = alignUp(nodes_[node].offset, alignment) - nodes_[node].offset;
+        if (nodes_[node].size >= size + padding) {
+            return node;
+        }
+    }
+    return INVALID_NODE;
+}
+
+// --- Node bookkeeping ---
+
+uint32_t TlsfAllocator::newNode() {
+    if (!unusedNodes_.empty()) {
+        uint32_t node = unusedNodes_.back();
+        unusedNodes_.pop_back();
+        nodes_[node] = Node{};
+        return node;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TlsfAllocator::releaseNode(uint32_t node) {
+    unusedNodes_.push_back(node);
+}
+
+void TlsfAllocator::insertFree(uint32_t node) {
+    uint32_t fl, sl;
+    mappingInsert(nodes_[node].size, fl, sl);
+
+    uint32_t head = freeHeads_[fl][sl];
+    nodes_[node].prevFree = INVALID_NODE;
+    nodes_[node].nextFree = head;
+    if (head != INVALID_NODE) {
+        nodes_[head].prevFree = node;
+    }
+    freeHeads_[fl][sl] = node;
+
+    flBitmap_ |= 1ull << fl;
+    slBitmaps_[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFree(uint32_t node) {
+    uint32_t fl, sl;
+    mappingInsert(nodes_[node].size, fl, sl);
+
+    uint32_t prev = nodes_[node].prevFree;
+    uint32_t next = nodes_[node].nextFree;
+    if (prev != INVALID_NODE) {
+        nodes_[prev].nextFree = next;
+    } else {
+        freeHeads_[fl][sl] = next;
+    }
+    if (next != INVALID_NODE) {
+        nodes_[next].prevFree = prev;
+    }
+
+    if (freeHeads_[fl][sl] == INVALID_NODE) {
+        slBitmaps_[fl] &= ~(1u << sl);
+        if (slBitmaps_[fl] == 0) {
+            flBitmap_ &= ~(1ull << fl);
+        }
+    }
+    nodes_[node].prevFree = INVALID_NODE;
+    nodes_[node].nextFree = INVALID_NODE;
+}
+
+void TlsfAllocator::splitTail(uint32_t node, uint64_t keepSize) {
+    uint32_t tail = newNode(); // May reallocate nodes_, so index from here on
+    nodes_[tail].offset = nodes_[node].offset + keepSize;
+    nodes_[tail].size = nodes_[node].size - keepSize;
+    nodes_[tail].isFree = true;
+    nodes_[tail].prevPhysical = node;
+    nodes_[tail].nextPhysical = nodes_[node].nextPhysical;
+    if (nodes_[tail].nextPhysical != INVALID_NODE) {
+        nodes_[nodes_[tail].nextPhysical].prevPhysical = tail;
+    }
+    nodes_[node].nextPhysical = tail;
+    nodes_[node].size = keepSize;
+    insertFree(tail);
+}
+
+void TlsfAllocator::mergeWithNext(uint32_t node) {
+    uint32_t next = nodes_[node].nextPhysical;
+    nodes_[node].size += nodes_[next].size;
+    nodes_[node].nextPhysical = nodes_[next].nextPhysical;
+    if (nodes_[node].nextPhysical != INVALID_NODE) {
+        nodes_[nodes_[node].nextPhysical].prevPhysical = node;
+    }
+    releaseNode(next);
+}
+
+} // namespace VulkanEngine
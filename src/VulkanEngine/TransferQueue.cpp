@@ -0,0 +1,179 @@
+#include "VulkanEngine/TransferQueue.h"
+#include "VulkanEngine/VulkanDevice.h"
+
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+TransferQueue::TransferQueue(VulkanDevice& device)
+    : device_(device.getDevice()),
+      queue_(device.getTransferQueue()),
+      transferFamily_(device.getQueueFamilyIndices().transferFamily.value()),
+      graphicsFamily_(device.getQueueFamilyIndices().graphicsFamily.value())
+{
+    vk::CommandPoolCreateInfo poolInfo(
+        vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        transferFamily_
+    );
+    commandPool_ = device_.createCommandPool(poolInfo);
+
+    vk::SemaphoreTypeCreateInfo timelineInfo(vk::SemaphoreType::eTimeline, 0);
+    vk::SemaphoreCreateInfo semaphoreInfo;
+    semaphoreInfo.pNext = &timelineInfo;
+    timeline_ = device_.createSemaphore(semaphoreInfo);
+}
+
+TransferQueue::~TransferQueue() {
+    // Let in-flight uploads finish before their command buffers go away
+    wait(UploadTicket{lastSubmittedValue_});
+    device_.destroySemaphore(timeline_);
+    device_.destroyCommandPool(commandPool_); // Frees all command buffers
+}
+
+vk::CommandBuffer TransferQueue::begin() {
+    recycleCommandBuffers();
+
+    vk::CommandBuffer commandBuffer;
+    if (!freeCommandBuffers_.empty()) {
+        commandBuffer = freeCommandBuffers_.back();
+        freeCommandBuffers_.pop_back();
+    } else {
+        vk::CommandBufferAllocateInfo allocInfo(commandPool_, vk::CommandBufferLevel::ePrimary, 1);
+        commandBuffer = device_.allocateCommandBuffers(allocInfo)[0];
+    }
+
+    // Begin implicitly resets (pool has eResetCommandBuffer)
+    vk::CommandBufferBeginInfo beginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    commandBuffer.begin(beginInfo);
+    return commandBuffer;
+}
+
+UploadTicket TransferQueue::submit(vk::CommandBuffer commandBuffer) {
+    commandBuffer.end();
+
+    uint64_t signalValue = lastSubmittedValue_ + 1;
+    vk::TimelineSemaphoreSubmitInfo timelineInfo(0, nullptr, 1, &signalValue);
+    vk::SubmitInfo submitInfo(0, nullptr, nullptr, 1, &commandBuffer, 1, &timeline_);
+    submitInfo.pNext = &timelineInfo;
+    queue_.submit(submitInfo, nullptr); // No wait: completion is tracked on the timeline
+
+    lastSubmittedValue_ = signalValue;
+    inFlight_.push_back({commandBuffer, signalValue});
+
+    // The releases in this command buffer now have a submission the graphics queue can wait on
+    submittedBufferAcquires_.insert(submittedBufferAcquires_.end(), recordingBufferAcquires_.begin(), recordingBufferAcquires_.end());
+    submittedImageAcquires_.insert(submittedImageAcquires_.end(), recordingImageAcquires_.begin(), recordingImageAcquires_.end());
+    submittedAcquireStages_ |= recordingAcquireStages_;
+    recordingBufferAcquires_.clear();
+    recordingImageAcquires_.clear();
+    recordingAcquireStages_ = {};
+
+    return UploadTicket{signalValue};
+}
+
+void TransferQueue::releaseBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size,
+                                  vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+    recordingAcquireStages_ |= dstStage;
+    if (!needsOwnershipTransfer()) {
+        // Same family: the timeline semaphore wait already makes the writes visible
+        return;
+    }
+
+    vk::BufferMemoryBarrier release(
+        vk::AccessFlagBits::eTransferWrite, {},
+        transferFamily_, graphicsFamily_,
+        buffer, offset, size
+    );
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+                                  {}, nullptr, release, nullptr);
+
+    vk::BufferMemoryBarrier acquire(
+        {}, dstAccess,
+        transferFamily_, graphicsFamily_,
+        buffer, offset, size
+    );
+    recordingBufferAcquires_.push_back(acquire);
+}
+
+void TransferQueue::releaseImage(vk::CommandBuffer commandBuffer, vk::Image image, const vk::ImageSubresourceRange& range,
+                                 vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+                                 vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+    recordingAcquireStages_ |= dstStage;
+    if (!needsOwnershipTransfer()) {
+        // Same family, a plain layout transition is enough
+        vk::ImageMemoryBarrier transition(
+            vk::AccessFlagBits::eTransferWrite, dstAccess,
+            oldLayout, newLayout,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+            image, range
+        );
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, dstStage,
+                                      {}, nullptr, nullptr, transition);
+        return;
+    }
+
+    // Release and acquire must describe the same layout transition
+    vk::ImageMemoryBarrier release(
+        vk::AccessFlagBits::eTransferWrite, {},
+        oldLayout, newLayout,
+        transferFamily_, graphicsFamily_,
+        image, range
+    );
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+                                  {}, nullptr, nullptr, release);
+
+    vk::ImageMemoryBarrier acquire(
+        {}, dstAccess,
+        oldLayout, newLayout,
+        transferFamily_, graphicsFamily_,
+        image, range
+    );
+    recordingImageAcquires_.push_back(acquire);
+}
+
+uint64_t TransferQueue::recordAcquires(vk::CommandBuffer graphicsCommandBuffer, vk::PipelineStageFlags& waitStages) {
+    if (lastSubmittedValue_ == lastAcquiredValue_) {
+        return 0;
+    }
+
+    // Uploads that never declared a consumer stage still have to be waited for
+    waitStages = submittedAcquireStages_ ? submittedAcquireStages_ : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eAllCommands);
+
+    if (!submittedBufferAcquires_.empty() || !submittedImageAcquires_.empty()) {
+        // srcStage matches the semaphore wait so the barrier chains after it
+        graphicsCommandBuffer.pipelineBarrier(waitStages, waitStages, {}, nullptr,
+                                              submittedBufferAcquires_, submittedImageAcquires_);
+    }
+    submittedBufferAcquires_.clear();
+    submittedImageAcquires_.clear();
+    submittedAcquireStages_ = {};
+
+    lastAcquiredValue_ = lastSubmittedValue_;
+    return lastAcquiredValue_;
+}
+
+bool TransferQueue::isComplete(UploadTicket ticket) const {
+    return getCompletedValue() >= ticket.value;
+}
+
+void TransferQueue::wait(UploadTicket ticket) const {
+    if (ticket.value == 0) {
+        return;
+    }
+    vk::SemaphoreWaitInfo waitInfo({}, 1, &timeline_, &ticket.value);
+    (void)device_.waitSemaphores(waitInfo, UINT64_MAX);
+}
+
+uint64_t TransferQueue::getCompletedValue() const {
+    return device_.getSemaphoreCounterValue(timeline_);
+}
+
+void TransferQueue::recycleCommandBuffers() {
+    uint64_t completed = getCompletedValue();
+    while (!inFlight_.empty() && inFlight_.front().value <= completed) {
+        freeCommandBuffers_.push_back(inFlight_.front().commandBuffer);
+        inFlight_.pop_front();
+    }
+}
+
+} // namespace VulkanEngine
@@ -0,0 +1,152 @@
+#include "VulkanEngine/UploadBatcher.h"
+
+#include <algorithm>
+#include <map>
+
+namespace VulkanEngine {
+
+UploadBatcher::UploadBatcher(TransferQueue& transferQueue, StagingRing& stagingRing)
+    : transferQueue_(transferQueue), stagingRing_(stagingRing)
+{
+}
+
+void UploadBatcher::enqueueCopy(vk::Buffer srcBuffer, vk::Buffer dstBuffer, const vk::BufferCopy& region,
+                                vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+    bufferCopies_.push_back({srcBuffer, dstBuffer, region, dstStage, dstAccess});
+}
+
+void UploadBatcher::enqueueBufferUpload(const void* data, vk::DeviceSize size, vk::Buffer dstBuffer, vk::DeviceSize dstOffset,
+                                        vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+    flushIfStagingFull(size);
+    StagingRing::Region staging = stagingRing_.upload(data, size);
+    stagedBytes_ += size;
+    enqueueCopy(staging.buffer, dstBuffer, vk::BufferCopy(staging.offset, dstOffset, size), dstStage, dstAccess);
+}
+
+void UploadBatcher::enqueueImageUpload(const void* data, vk::DeviceSize size, vk::Image dstImage,
+                                       const vk::BufferImageCopy& copy, const vk::ImageSubresourceRange& range,
+                                       vk::ImageLayout finalLayout, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+    flushIfStagingFull(size);
+    StagingRing::Region staging = stagingRing_.upload(data, size);
+    stagedBytes_ += size;
+
+    vk::BufferImageCopy stagedCopy = copy;
+    stagedCopy.bufferOffset += staging.offset;
+    imageCopies_.push_back({staging.buffer, dstImage, stagedCopy, range, finalLayout, dstStage, dstAccess});
+}
+
+UploadBatcher::FlushStats UploadBatcher::flush() {
+    FlushStats stats;
+    if (empty()) {
+        return stats;
+    }
+
+    vk::CommandBuffer commandBuffer = transferQueue_.begin();
+
+    // --- Buffer copies ---
+    // Copies between the same pair of buffers end up adjacent, ordered by source offset.
+    // Destinations within one batch are expected not to overlap, so reordering is safe.
+    std::stable_sort(bufferCopies_.begin(), bufferCopies_.end(), [](const PendingBufferCopy& a, const PendingBufferCopy& b) {
+        if (a.src != b.src) return a.src < b.src;
+        if (a.dst != b.dst) return a.dst < b.dst;
+        return a.region.srcOffset < b.region.srcOffset;
+    });
+
+    struct Release {
+        vk::DeviceSize begin;
+        vk::DeviceSize end;
+        vk::PipelineStageFlags dstStage;
+        vk::AccessFlags dstAccess;
+    };
+    std::map<vk::Buffer, Release> releases;
+
+    std::vector<vk::BufferCopy> regions;
+    for (size_t i = 0; i < bufferCopies_.size(); i++) {
+        const PendingBufferCopy& pending = bufferCopies_[i];
+        stats.copiesQueued++;
+        stats.bytes += pending.region.size;
+
+        // Contiguous in both buffers: extend the previous region instead of adding one
+        if (!regions.empty() &&
+            regions.back().srcOffset + regions.back().size == pending.region.srcOffset &&
+            regions.back().dstOffset + regions.back().size == pending.region.dstOffset) {
+            regions.back().size += pending.region.size;
+        } else {
+            regions.push_back(pending.region);
+        }
+
+        auto [it, inserted] = releases.try_emplace(pending.dst, Release{
+            pending.region.dstOffset, pending.region.dstOffset + pending.region.size, pending.dstStage, pending.dstAccess});
+        if (!inserted) {
+            it->second.begin = std::min(it->second.begin, pending.region.dstOffset);
+            it->second.end = std::max(it->second.end, pending.region.dstOffset + pending.region.size);
+            it->second.dstStage |= pending.dstStage;
+            it->second.dstAccess |= pending.dstAccess;
+        }
+
+        bool lastOfPair = i + 1 == bufferCopies_.size() ||
+                          bufferCopies_[i + 1].src != pending.src || bufferCopies_[i + 1].dst != pending.dst;
+        if (lastOfPair) {
+            commandBuffer.copyBuffer(pending.src, pending.dst, regions);
+            stats.copiesRecorded += static_cast<uint32_t>(regions.size());
+            regions.clear();
+        }
+    }
+    stats.copiesMerged = stats.copiesQueued - stats.copiesRecorded;
+
+    for (const auto& [buffer, release] : releases) {
+        transferQueue_.releaseBuffer(commandBuffer, buffer, release.begin, release.end - release.begin,
+                                     release.dstStage, release.dstAccess);
+    }
+
+    // --- Image copies ---
+    if (!imageCopies_.empty()) {
+        std::stable_sort(imageCopies_.begin(), imageCopies_.end(), [](const PendingImageCopy& a, const PendingImageCopy& b) {
+            return a.dst < b.dst;
+        });
+
+        // New images: no previous contents to keep
+        std::vector<vk::ImageMemoryBarrier> toTransferDst;
+        for (size_t i = 0; i < imageCopies_.size(); i++) {
+            if (i == 0 || imageCopies_[i].dst != imageCopies_[i - 1].dst) {
+                toTransferDst.emplace_back(
+                    vk::AccessFlags{}, vk::AccessFlagBits::eTransferWrite,
+                    vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                    imageCopies_[i].dst, imageCopies_[i].range
+                );
+            }
+        }
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                      {}, nullptr, nullptr, toTransferDst);
+
+        for (size_t i = 0; i < imageCopies_.size(); i++) {
+            const PendingImageCopy& pending = imageCopies_[i];
+            commandBuffer.copyBufferToImage(pending.src, pending.dst, vk::ImageLayout::eTransferDstOptimal, pending.copy);
+            stats.imageCopies++;
+
+            if (i + 1 == imageCopies_.size() || imageCopies_[i + 1].dst != pending.dst) {
+                transferQueue_.releaseImage(commandBuffer, pending.dst, pending.range,
+                                            vk::ImageLayout::eTransferDstOptimal, pending.finalLayout,
+                                            pending.dstStage, pending.dstAccess);
+            }
+        }
+    }
+
+    stats.ticket = transferQueue_.submit(commandBuffer);
+    stagingRing_.closeSubmission(transferQueue_.getTimeline(), stats.ticket.value);
+
+    bufferCopies_.clear();
+    imageCopies_.clear();
+    stagedBytes_ = 0;
+    return stats;
+}
+
+void UploadBatcher::flushIfStagingFull(vk::DeviceSize incomingBytes) {
+    // Half the ring leaves room for whatever the GPU is still copying from the last flush
+    if (!empty() && stagedBytes_ + incomingBytes > stagingRing_.getSize() / 2) {
+        flush();
+    }
+}
+
+} // namespace VulkanEngine
@@ -179,7 +179,8 @@ void VulkanDevice::createLogicalDevice() {
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {
         queueFamilyIndices_.graphicsFamily.value(),
-        queueFamilyIndices_.presentFamily.value()
+        queueFamilyIndices_.presentFamily.value(),
+        queueFamilyIndices_.transferFamily.value()
     };
 
     float queuePriority = 1.0f;
@@ -192,13 +193,69 @@ void VulkanDevice::createLogicalDevice() {
     }
 
     vk::PhysicalDeviceFeatures deviceFeatures{}; // Enable features as needed
+    // GPU-driven drawing: many indirect draws per call, with the count read from a buffer (1.2)
+    vk::PhysicalDeviceFeatures supportedFeatures = physicalDevice_.getFeatures();
+
+    // Uploads and frames are tracked with timeline semaphores (core in Vulkan 1.2)
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    // Bindless: large update-after-bind arrays indexed from shaders (core descriptor indexing, 1.2).
+    // All or nothing, the engine falls back to classic descriptors otherwise.
+    auto supported12 = physicalDevice_.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>()
+                           .get<vk::PhysicalDeviceVulkan12Features>();
+    bindlessEnabled_ = supported12.descriptorIndexing && supported12.runtimeDescriptorArray &&
+                       supported12.descriptorBindingPartiallyBound &&
+                       supported12.descriptorBindingStorageBufferUpdateAfterBind &&
+                       supported12.descriptorBindingSampledImageUpdateAfterBind &&
+                       supported12.shaderStorageBufferArrayNonUniformIndexing &&
+                       supported12.shaderSampledImageArrayNonUniformIndexing;
+    indirectCountEnabled_ = supportedFeatures.multiDrawIndirect && supported12.drawIndirectCount;
+    if (indirectCountEnabled_) {
+        deviceFeatures.multiDrawIndirect = VK_TRUE;
+        vulkan12Features.drawIndirectCount = VK_TRUE;
+    }
+    if (bindlessEnabled_) {
+        vulkan12Features.descriptorIndexing = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    }
+
+    // Rendering without render pass and framebuffer objects, when available.
+    // Only the core 1.3 version is used: the KHR entry points are not exported by the loader.
+    vk::PhysicalDeviceVulkan13Features vulkan13Features{};
+    if (physicalDevice_.getProperties().apiVersion >= VK_API_VERSION_1_3) {
+        auto features = physicalDevice_.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan13Features>();
+        dynamicRenderingEnabled_ = features.get<vk::PhysicalDeviceVulkan13Features>().dynamicRendering;
+    }
+    if (dynamicRenderingEnabled_) {
+        vulkan13Features.dynamicRendering = VK_TRUE;
+        vulkan12Features.pNext = &vulkan13Features;
+    }
+
+    std::vector<const char*> extensions = deviceExtensions_;
+    std::vector<vk::ExtensionProperties> availableExtensions = physicalDevice_.enumerateDeviceExtensionProperties();
+    for (const char* optionalExtension : optionalDeviceExtensions_) {
+        for (const auto& extension : availableExtensions) {
+            if (strcmp(optionalExtension, extension.extensionName) == 0) {
+                extensions.push_back(optionalExtension);
+                break;
+            }
+        }
+    }
+    enabledExtensions_ = std::set<std::string>(extensions.begin(), extensions.end());
 
     vk::DeviceCreateInfo createInfo;
+    createInfo.pNext = &vulkan12Features;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions_.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions_.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (enableValidationLayers_) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers_.size());
@@ -211,6 +268,11 @@ void VulkanDevice::createLogicalDevice() {
 
     graphicsQueue_ = device_.getQueue(queueFamilyIndices_.graphicsFamily.value(), 0);
     presentQueue_ = device_.getQueue(queueFamilyIndices_.presentFamily.value(), 0);
+    transferQueue_ = device_.getQueue(queueFamilyIndices_.transferFamily.value(), 0);
+
+    if (hasDedicatedTransferQueue()) {
+        std::cout << "Using dedicated transfer queue family " << queueFamilyIndices_.transferFamily.value() << std::endl;
+    }
 }
 
 // --- Helper Implementations ---
@@ -263,28 +325,46 @@ bool VulkanDevice::isDeviceSuitable(vk::PhysicalDevice queryDevice) const {
               swapChainAdequate = !formats.empty() && !presentModes.empty();
          }
     }
-    return indices.isComplete() && extensionsSupported && swapChainAdequate;
+    return indices.isComplete() && extensionsSupported && swapChainAdequate && checkDeviceFeatureSupport(queryDevice);
 }
 
 QueueFamilyIndices VulkanDevice::findQueueFamilies(vk::PhysicalDevice queryDevice) const {
     QueueFamilyIndices indices;
     std::vector<vk::QueueFamilyProperties> queueFamilies = queryDevice.getQueueFamilyProperties();
-    int i = 0;
+    std::optional<uint32_t> transferOnlyFamily; // No graphics or compute: a DMA engine
+    std::optional<uint32_t> nonGraphicsTransferFamily; // Async compute also copies off the graphics queue
+    uint32_t i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) {
+        if ((queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) && !indices.graphicsFamily) {
             indices.graphicsFamily = i;
         }
         // Need surface_ member to check presentation support
-        if (surface_) {
+        if (surface_ && !indices.presentFamily) {
             VkBool32 presentSupport = queryDevice.getSurfaceSupportKHR(i, surface_);
             if (presentSupport) {
                 indices.presentFamily = i;
             }
         } // Handle case where surface might not exist yet if needed
 
-        if (indices.isComplete()) break;
+        // Graphics and compute families implicitly support transfer
+        bool canTransfer = static_cast<bool>(queueFamily.queueFlags & (vk::QueueFlagBits::eTransfer | vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+        if (canTransfer && !(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)) {
+            if (!(queueFamily.queueFlags & vk::QueueFlagBits::eCompute) && !transferOnlyFamily) {
+                transferOnlyFamily = i;
+            } else if (!nonGraphicsTransferFamily) {
+                nonGraphicsTransferFamily = i;
+            }
+        }
         i++;
     }
+
+    if (transferOnlyFamily) {
+        indices.transferFamily = transferOnlyFamily;
+    } else if (nonGraphicsTransferFamily) {
+        indices.transferFamily = nonGraphicsTransferFamily;
+    } else {
+        indices.transferFamily = indices.graphicsFamily;
+    }
     return indices;
 }
 
@@ -297,6 +377,15 @@ bool VulkanDevice::checkDeviceExtensionSupport(vk::PhysicalDevice queryDevice) c
     return requiredExtensions.empty();
 }
 
+bool VulkanDevice::checkDeviceFeatureSupport(vk::PhysicalDevice queryDevice) const {
+    // Vulkan12Features can only be queried on 1.2 devices
+    if (queryDevice.getProperties().apiVersion < VK_API_VERSION_1_2) {
+        return false;
+    }
+    auto features = queryDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    return features.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore;
+}
+
 // Implementation for findSupportedFormat
 vk::Format VulkanDevice::findSupportedFormat(
     const std::vector<vk::Format>& candidates,
@@ -324,6 +413,21 @@ vk::Format VulkanDevice::findDepthFormat() const {
     );
 }
 
+// Moved from Engine, MemoryAllocator picks memory types through this
+uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const {
+    vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice_.getMemoryProperties();
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+bool VulkanDevice::isExtensionEnabled(const std::string& name) const {
+    return enabledExtensions_.count(name) > 0;
+}
+
 // --- Swap Chain Helper Definitions (Moved from Engine) ---
 vk::SurfaceFormatKHR VulkanDevice::chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& availableFormats) const {
     for (const auto& availableFormat : availableFormats) {
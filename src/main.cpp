@@ -3,10 +3,54 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    // --frames-in-flight N: 1 for lowest latency, more for CPU/GPU overlap
+    // --hot-reload: recompile and swap in shaders edited while running
+    // --stress [N]: N instanced rounded cubes with LODs instead of one cube (default 100000)
+    // --cpu-cull: SIMD frustum culling on the CPU instead of the compute pass
+    // --mesh <file.obj|file.glb>: draws the model instead of the cube (or rounded cubes with --stress)
+    uint32_t framesInFlight = 2;
+    bool hotReload = false;
+    uint32_t stressObjects = 0;
+    bool cpuCulling = false;
+    const char* meshPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            framesInFlight = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--hot-reload") == 0) {
+            hotReload = true;
+        } else if (std::strcmp(argv[i], "--cpu-cull") == 0) {
+            cpuCulling = true;
+        } else if (std::strcmp(argv[i], "--mesh") == 0 && i + 1 < argc) {
+            meshPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--stress") == 0) {
+            stressObjects = 100000;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                stressObjects = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        }
+    }
 
-int main() {
     // Create an instance of the engine
-    VulkanEngine::Engine engine(1024, 768, "Vulkan Engine Refactored"); // Example: Use different size/title
+    VulkanEngine::Engine engine(1024, 768, "Vulkan Engine Refactored", framesInFlight); // Example: Use different size/title
+    if (stressObjects > 0) {
+        engine.enableStressScene(stressObjects);
+    }
+    if (cpuCulling) {
+        engine.enableCpuCulling();
+    }
+    if (meshPath) {
+        engine.enableMeshFile(meshPath);
+    }
+    if (hotReload) {
+#if defined(SHADER_SOURCE_DIR) && defined(GLSLC_EXECUTABLE)
+        engine.enableShaderHotReload(SHADER_SOURCE_DIR, GLSLC_EXECUTABLE);
+#else
+        engine.enableShaderHotReload("shaders", "glslc");
+#endif
+    }
 
     try {
         // Run the engine
@@ -17,4 +61,4 @@ int main() {
     }
 
     return EXIT_SUCCESS;
-} 
\ No newline at end of file
+}
@@ -0,0 +1,144 @@
+// Packs files into an asset bundle (see include/VulkanEngine/AssetBundleFormat.h), or into
+// a header that embeds them in the executable.
+//
+//   pack_assets bundle <out.bundle> <name>=<file> ...
+//   pack_assets header <out.inc> <name>=<file> ...
+
+#include "VulkanEngine/AssetBundleFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+namespace {
+
+struct Input {
+    std::string name;
+    std::vector<char> data;
+};
+
+std::vector<char> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    return data;
+}
+
+// Written next to the output and renamed over it, so an interrupted build never leaves half a file
+void writeAtomically(const std::string& path, const std::string& contents) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!file) {
+            throw std::runtime_error("Failed to write " + tempPath);
+        }
+    }
+    std::filesystem::rename(tempPath, path);
+}
+
+std::string buildBundle(const std::vector<Input>& inputs) {
+    auto alignUp = [](uint64_t value) { return (value + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT; };
+
+    BundleHeader header{BUNDLE_MAGIC, BUNDLE_VERSION, static_cast<uint32_t>(inputs.size()), 0};
+    std::vector<BundleEntry> entries(inputs.size());
+    uint64_t offset = alignUp(sizeof(BundleHeader) + entries.size() * sizeof(BundleEntry));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::memset(&entries[i], 0, sizeof(BundleEntry));
+        std::memcpy(entries[i].name, inputs[i].name.c_str(), inputs[i].name.size());
+        entries[i].offset = offset;
+        entries[i].size = inputs[i].data.size();
+        offset = alignUp(offset + inputs[i].data.size());
+    }
+
+    std::string out(offset, '\0');
+    std::memcpy(&out[0], &header, sizeof(header));
+    std::memcpy(&out[sizeof(header)], entries.data(), entries.size() * sizeof(BundleEntry));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::memcpy(&out[entries[i].offset], inputs[i].data.data(), inputs[i].data.size());
+    }
+    return out;
+}
+
+std::string buildHeader(const std::vector<Input>& inputs) {
+    std::string out = "// Generated by pack_assets, do not edit\n"
+                      "#include <cstddef>\n#include <cstdint>\n\n"
+                      "struct EmbeddedAsset {\n    const char* name;\n    const void* data;\n    size_t size;\n};\n\n";
+    char word[16];
+    for (size_t i = 0; i < inputs.size(); i++) {
+        // uint32_t words keep SPIR-V aligned, the tail is zero padded
+        const std::vector<char>& data = inputs[i].data;
+        out += "alignas(" + std::to_string(BUNDLE_ALIGNMENT) + ") static const uint32_t EMBEDDED_ASSET_" + std::to_string(i) + "[] = {";
+        size_t wordCount = (data.size() + 3) / 4;
+        for (size_t w = 0; w < std::max<size_t>(wordCount, 1); w++) {
+            uint32_t value = 0;
+            size_t bytes = std::min<size_t>(4, data.size() - std::min(data.size(), w * 4));
+            std::memcpy(&value, data.data() + w * 4, bytes);
+            std::snprintf(word, sizeof(word), "0x%08x,", value);
+            out += (w % 8 == 0 ? "\n    " : " ");
+            out += word;
+        }
+        out += "\n};\n";
+    }
+    out += "\nstatic const EmbeddedAsset EMBEDDED_ASSETS[] = {\n";
+    for (size_t i = 0; i < inputs.size(); i++) {
+        out += "    {\"" + inputs[i].name + "\", EMBEDDED_ASSET_" + std::to_string(i) + ", " +
+               std::to_string(inputs[i].data.size()) + "},\n";
+    }
+    if (inputs.empty()) {
+        out += "    {\"\", nullptr, 0},\n";
+    }
+    out += "};\n";
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (std::strcmp(argv[1], "bundle") != 0 && std::strcmp(argv[1], "header") != 0)) {
+        std::cerr << "Usage: pack_assets bundle|header <output> <name>=<file> ..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::vector<Input> inputs;
+        for (int i = 3; i < argc; i++) {
+            std::string argument = argv[i];
+            size_t split = argument.find('=');
+            if (split == std::string::npos || split == 0) {
+                throw std::runtime_error("Expected <name>=<file>, got " + argument);
+            }
+            Input input{argument.substr(0, split), readFile(argument.substr(split + 1))};
+            if (input.name.size() >= BUNDLE_NAME_SIZE || input.name.find_first_of("\"\\") != std::string::npos) {
+                throw std::runtime_error("Bad asset name: " + input.name);
+            }
+            inputs.push_back(std::move(input));
+        }
+
+        bool bundle = std::strcmp(argv[1], "bundle") == 0;
+        writeAtomically(argv[2], bundle ? buildBundle(inputs) : buildHeader(inputs));
+
+        size_t totalBytes = 0;
+        for (const Input& input : inputs) {
+            totalBytes += input.data.size();
+        }
+        std::cout << "Packed " << inputs.size() << " assets (" << totalBytes << " bytes) into " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "pack_assets: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}